@@ -0,0 +1,55 @@
+/*
+ * The frequency bands BeatDetector looks for beats in.
+ *
+ * One line per band, BeatDetector builds one BandDetector per line at compile time and
+ * keeps them in one array. Add lines for fixtures that want more bands; the first three
+ * are the classic low/mid/high ones behind lowBeat/midBeat/highBeat, all of them show up
+ * in BeatDetector::beat[].
+ *
+ * bins are fft256 bins of 172 Hz (44100 / 256), both ends included.
+ * window is the number of fft frames average and max are taken over, with averageTogether(3)
+ * there are about 115 frames per second. It can't be more than MAX_BAND_WINDOW.
+ */
+
+#ifndef BANDCONFIG_H
+#define BANDCONFIG_H
+
+#include <stdint.h>
+
+struct BandConfig
+{
+    uint8_t firstBin;
+    uint8_t lastBin;
+    uint8_t window;        // fft frames
+    float thresholdFactor; // position of the beat threshold between average (0) and max (1) audio value
+    float silenceFactor;   // see BandDetector.h
+    uint16_t retriggerTime; // ms a new beat is ignored after a beat
+};
+
+constexpr BandConfig BEAT_BANDS[] = {
+    // bins     window threshold silence retrigger
+    {0, 0, 115, .7, .75, 200},   // low: kick drum
+    {25, 80, 70, .4, .75, 100},  // mid: threshold was 0.8 but that totaly doesn't work anymore.
+    {89, 127, 70, .07, .5, 150}, // high: hi-hats and cymbals
+};
+
+constexpr int NUM_BEAT_BANDS = sizeof(BEAT_BANDS) / sizeof(BEAT_BANDS[0]);
+constexpr int LOW_BAND = 0;
+constexpr int MID_BAND = 1;
+constexpr int HIGH_BAND = 2;
+
+// spectral flux onsets are thresholded like a band, bins aren't used
+constexpr BandConfig ONSET_BAND = {0, 127, 70, .5, .75, 100};
+
+constexpr int MAX_BAND_WINDOW = 128;
+
+constexpr bool bandsValid(int i = 0)
+{
+    return i == NUM_BEAT_BANDS || (BEAT_BANDS[i].window > 0 && BEAT_BANDS[i].window <= MAX_BAND_WINDOW &&
+                                   BEAT_BANDS[i].firstBin <= BEAT_BANDS[i].lastBin && BEAT_BANDS[i].lastBin < 128 &&
+                                   bandsValid(i + 1));
+}
+static_assert(NUM_BEAT_BANDS >= 3, "BEAT_BANDS needs at least the low, mid and high band");
+static_assert(bandsValid(), "BEAT_BANDS: window must be 1..MAX_BAND_WINDOW and bins 0..127");
+
+#endif // BANDCONFIG_H
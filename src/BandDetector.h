@@ -0,0 +1,130 @@
+/*
+ * Beat detection for one frequency band, used by BeatDetector for every band in BandConfig.h.
+ *
+ * Keeps a running total over the last window fft frames for the average and,
+ * next to it, a monotonic deque for the maximum over the same window. The deque
+ * holds only readings that could still become the maximum (values decreasing from
+ * front to back) so each reading is pushed and popped at most once: O(1) per frame
+ * like the running total, and the max follows loudness changes smoothly instead of
+ * jumping once per window.
+ */
+
+#ifndef BANDDETECTOR_H
+#define BANDDETECTOR_H
+
+#include <Audio.h>
+#include "BandConfig.h"
+#include "TelemetryFormat.h"
+
+// MaxReadings is the storage for the window, the window length itself comes from the BandConfig
+// so bands with different windows can share one type and live in one array.
+template <int MaxReadings>
+class BandDetector
+{
+public:
+    BandDetector(const BandConfig &config)
+        : thresholdFactor(config.thresholdFactor), silenceFactor(config.silenceFactor), retriggerTime(config.retriggerTime),
+          numReadings(config.window), inverseNumReadings(1.0f / config.window) {}
+
+    // feed the band's magnitude for this fft frame. returns audioValue if it is a beat, 0 otherwise
+    float update(float value)
+    {
+        audioValue = value;
+
+        // running total for the average
+        total = total - readings[readIndex];
+        readings[readIndex] = audioValue;
+        total = total + audioValue;
+        if (++readIndex >= numReadings)
+        {
+            readIndex = 0;
+        }
+
+        // rolling max: drop readings that fell out of the window from the front,
+        // and readings that can never be the max again (smaller than this one) from the back
+        if (dequeSize && frame - dequeFrame[dequeHead] >= (uint32_t)numReadings)
+        {
+            dequeHead = (dequeHead + 1) % MaxReadings;
+            dequeSize--;
+        }
+        while (dequeSize && dequeValue[(dequeHead + dequeSize - 1) % MaxReadings] <= audioValue)
+        {
+            dequeSize--;
+        }
+        int tail = (dequeHead + dequeSize) % MaxReadings;
+        dequeFrame[tail] = frame;
+        dequeValue[tail] = audioValue;
+        dequeSize++;
+        frame++;
+        maxValue = dequeValue[dequeHead];
+
+        // calculate the average:
+        average = total * inverseNumReadings;
+
+        // what I'm trying to do here is limit the rate of change to the averageSmoothing value.
+        // This will be effected by rate of fft data as set in setup() fftaverage.
+        if (oldAverage - average > averageSmoothing)
+        {
+            average = oldAverage - averageSmoothing;
+        }
+        if (average - oldAverage > averageSmoothing)
+        {
+            average = oldAverage + averageSmoothing;
+        }
+        oldAverage = average;
+
+        thresholdValue = (maxValue - average) * thresholdFactor + average; // threshold is set between the average and the max seen in the window
+
+        // beat has to beat the threshold, be well above the average (ignores quiet sections without a beat)
+        // and be more than retriggerTime ms away from the last beat detected.
+        if (audioValue > thresholdValue && audioValue > 2 * average && retrigger > retriggerTime)
+        {
+            retrigger = 0;
+            return audioValue;
+        }
+        return 0;
+    }
+
+    float level() const { return audioValue; } // current magnitude in read() units
+
+    // fills in the values of the last update for the telemetry ring (Telemetry.h)
+    void telemetry(TelemetryRecord &record)
+    {
+        record.average = average;
+        record.maxValue = maxValue;
+        record.threshold = thresholdValue;
+        record.value = audioValue;
+        record.flags = retrigger > retriggerTime ? TELEMETRY_READY : 0;
+    }
+
+    float thresholdFactor; // position of the beat threshold between average (0) and max (1) audio value
+    float silenceFactor;   // max audio signal seen in the window is multiplied by this. if the result is less than the average audio signal then beat detected is ignored (silent vocal bits in song). not used by update() at the moment
+    uint32_t retriggerTime; // time that a new beat detected will be ignored
+
+    // values from the last update, handy for plotting
+    float audioValue = 0;
+    float average = 0;
+    float maxValue = 0;
+    float thresholdValue = 0;
+
+    const float averageSmoothing = 0.0001;
+
+private:
+    int numReadings;          // window length in fft frames
+    float inverseNumReadings; // multiply instead of divide every frame
+    float readings[MaxReadings] = {}; // the last numReadings band magnitudes
+    int readIndex = 0;                // the index of the current reading
+    float total = 0;                  // the running total
+    float oldAverage = 0;
+
+    // monotonic deque as a ring buffer. at most numReadings entries are ever in the window.
+    uint32_t frame = 0; // frames seen so far, used to age deque entries out of the window
+    uint32_t dequeFrame[MaxReadings] = {};
+    float dequeValue[MaxReadings] = {};
+    int dequeHead = 0;
+    int dequeSize = 0;
+
+    elapsedMillis retrigger = 0;
+};
+
+#endif // BANDDETECTOR_H
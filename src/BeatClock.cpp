@@ -0,0 +1,116 @@
+#include "BeatClock.h"
+
+void BeatClock::setTempo(float bpm)
+{
+    if (bpm <= 0)
+    {
+        period = 0;
+        nominalPeriod = 0;
+        aligned = false;
+        return;
+    }
+
+    uint32_t tempoPeriod = (uint32_t)(60000000.0f / bpm);
+    if (period == 0)
+    {
+        // starting up. the grid is placed by the next detected beat
+        period = tempoPeriod;
+    }
+    else if (nominalPeriod != tempoPeriod)
+    {
+        // follow the tracker but keep the trim the loop has learned so far
+        period = (uint32_t)((int32_t)tempoPeriod + ((int32_t)period - (int32_t)nominalPeriod));
+    }
+    nominalPeriod = tempoPeriod;
+
+    uint32_t maxTrim = (uint32_t)(nominalPeriod * MAX_PERIOD_TRIM);
+    if (period > nominalPeriod + maxTrim)
+    {
+        period = nominalPeriod + maxTrim;
+    }
+    if (period < nominalPeriod - maxTrim)
+    {
+        period = nominalPeriod - maxTrim;
+    }
+    nextBeat = lastBeat + period;
+}
+
+void BeatClock::beatDetected(uint32_t atMicros)
+{
+    if (period == 0)
+    {
+        return;
+    }
+
+    // error against the nearest predicted beat, -period/2..period/2
+    int32_t error = (int32_t)(atMicros - lastBeat);
+    if (error > (int32_t)(period / 2))
+    {
+        error -= period;
+    }
+    if (!aligned || error < -(int32_t)(period / 2) || error > (int32_t)(period / 2))
+    {
+        // first beat, or out of any sensible range (loop wasn't updated for a while): restart on this beat
+        lastBeat = atMicros;
+        nextBeat = lastBeat + period;
+        aligned = true;
+        return;
+    }
+
+    lastBeat += (int32_t)(error * PHASE_GAIN);
+    int32_t trimmed = (int32_t)period + (int32_t)(error * FREQUENCY_GAIN);
+    int32_t maxTrim = (int32_t)(nominalPeriod * MAX_PERIOD_TRIM);
+    if (trimmed > (int32_t)nominalPeriod + maxTrim)
+    {
+        trimmed = nominalPeriod + maxTrim;
+    }
+    if (trimmed < (int32_t)nominalPeriod - maxTrim)
+    {
+        trimmed = nominalPeriod - maxTrim;
+    }
+    period = trimmed;
+    nextBeat = lastBeat + period;
+}
+
+void BeatClock::setBeat(uint32_t atMicros, float bpm)
+{
+    if (bpm <= 0)
+    {
+        return;
+    }
+    nominalPeriod = (uint32_t)(60000000.0f / bpm);
+    period = nominalPeriod;
+    lastBeat = atMicros;
+    nextBeat = lastBeat + period;
+    aligned = true;
+}
+
+bool BeatClock::update(uint32_t nowMicros)
+{
+    if (!running() || (int32_t)(nowMicros - nextBeat) < 0)
+    {
+        return false;
+    }
+    // skip whole beats we slept through so there is only one flag per call
+    while ((int32_t)(nowMicros - nextBeat) >= 0)
+    {
+        lastBeat = nextBeat;
+        nextBeat += period;
+    }
+    return true;
+}
+
+uint8_t BeatClock::phase(uint32_t nowMicros) const
+{
+    if (!running())
+    {
+        return 0;
+    }
+    // lastBeat can be a little in the future right after a phase correction
+    int32_t sinceBeat = (int32_t)(nowMicros - lastBeat) % (int32_t)period;
+    if (sinceBeat < 0)
+    {
+        sinceBeat += period;
+    }
+    return (uint8_t)(((uint64_t)sinceBeat << 8) / period);
+}
@@ -0,0 +1,44 @@
+/*
+ * Phase locked beat clock behind BeatDetector's virtual beat.
+ *
+ * The tempo tracker gives the period, detected low beats give the phase. Each low
+ * beat is compared with the nearest predicted beat and the error nudges the clock:
+ * PHASE_GAIN of it moves the beat grid, FREQUENCY_GAIN of it trims the period, a
+ * second order PLL like the ones used for clock recovery. The period is kept within
+ * a few percent of the tracker's tempo so a run of misdetected beats can't drag it off.
+ *
+ * Everything is in micros() so the predicted beat times and the phase don't depend
+ * on when the main loop happens to run. Patterns can ask for phase(micros()) at the
+ * moment they render, or use nextBeat to schedule something exactly on the beat.
+ */
+
+#ifndef BEATCLOCK_H
+#define BEATCLOCK_H
+
+#include <stdint.h>
+
+class BeatClock
+{
+public:
+    void setTempo(float bpm);           // from the tempo tracker, 0 stops the clock
+    void beatDetected(uint32_t atMicros); // a detected beat, already corrected for detection latency
+    bool update(uint32_t nowMicros);    // true once for every beat that passed since the last call
+    void setBeat(uint32_t atMicros, float bpm); // force the grid onto a known beat, for beats that don't need locking (beat maps)
+
+    uint8_t phase(uint32_t nowMicros) const; // 0 on the beat, counting up to 255 just before the next one
+    bool running() const { return period > 0 && aligned; } // has a tempo and heard at least one beat
+
+    uint32_t lastBeat = 0; // predicted time of the last beat, micros()
+    uint32_t nextBeat = 0; // predicted time of the next beat, micros()
+    uint32_t period = 0;   // current beat period in micros, 0 when stopped
+
+    const float PHASE_GAIN = 0.25;      // fraction of the phase error corrected per detected beat
+    const float FREQUENCY_GAIN = 0.05;  // fraction of the phase error added to the period per detected beat
+    const float MAX_PERIOD_TRIM = 0.04; // the period stays within 4% of the tempo tracker's
+
+private:
+    uint32_t nominalPeriod = 0; // from the tempo tracker
+    bool aligned = false;       // the grid was placed by a detected beat
+};
+
+#endif // BEATCLOCK_H
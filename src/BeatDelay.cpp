@@ -0,0 +1,53 @@
+#include "BeatDelay.h"
+
+void BeatDelay::push(uint32_t dueMicros, const float *beats, float onset)
+{
+    bool any = onset != 0;
+    for (int i = 0; i < NUM_BEAT_BANDS; i++)
+    {
+        any = any || beats[i] != 0;
+    }
+    if (!any || count == SIZE) // nothing to wait for, or full
+    {
+        return;
+    }
+    Entry &entry = entries[(head + count) % SIZE];
+    entry.due = dueMicros;
+    for (int i = 0; i < NUM_BEAT_BANDS; i++)
+    {
+        entry.beat[i] = beats[i];
+    }
+    entry.onset = onset;
+    count++;
+}
+
+bool BeatDelay::pop(uint32_t nowMicros, float *beats, float &onset)
+{
+    for (int i = 0; i < NUM_BEAT_BANDS; i++)
+    {
+        beats[i] = 0;
+    }
+    onset = 0;
+
+    // entries are pushed in time order, so the due ones are all at the front
+    bool due = false;
+    while (count && (int32_t)(nowMicros - entries[head].due) >= 0)
+    {
+        Entry &entry = entries[head];
+        for (int i = 0; i < NUM_BEAT_BANDS; i++)
+        {
+            if (entry.beat[i] > beats[i])
+            {
+                beats[i] = entry.beat[i];
+            }
+        }
+        if (entry.onset > onset)
+        {
+            onset = entry.onset;
+        }
+        head = (head + 1) % SIZE;
+        count--;
+        due = true;
+    }
+    return due;
+}
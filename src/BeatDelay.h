@@ -0,0 +1,45 @@
+/*
+ * Holds detected beat flags back until the audio they were detected in is heard.
+ *
+ * With lookahead (BeatDetector::lookahead) the fft gets the audio before the speakers
+ * do, so a beat is detected up to lookahead - detectionLatency early. BeatDetector
+ * pushes every frame's flags here with the time they are due and pops them again in
+ * the loop that reaches that time, which makes lowBeat & co. line up with the music
+ * instead of trailing it.
+ */
+
+#ifndef BEATDELAY_H
+#define BEATDELAY_H
+
+#include <stdint.h>
+#include "BandConfig.h"
+
+class BeatDelay
+{
+public:
+    // flags of one fft frame, due at dueMicros. frames without a beat aren't kept, and nothing is if the delay is full
+    void push(uint32_t dueMicros, const float *beats, float onset);
+
+    // overwrites beats/onset with everything that came due by nowMicros (the strongest if
+    // several did), 0 where nothing did. true if anything was due
+    bool pop(uint32_t nowMicros, float *beats, float &onset);
+
+    void clear() { count = 0; }
+
+    // frames with a beat that can wait at the same time. about 10 frames per 100 ms
+    // of lookahead can hold beats (retrigger times are 100 ms and up)
+    static const int SIZE = 32;
+
+private:
+    struct Entry
+    {
+        uint32_t due;
+        float beat[NUM_BEAT_BANDS];
+        float onset;
+    };
+    Entry entries[SIZE];
+    int head = 0;  // oldest entry
+    int count = 0;
+};
+
+#endif // BEATDELAY_H
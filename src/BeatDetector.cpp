@@ -0,0 +1,205 @@
+#include "BeatDetector.h"
+
+BeatDetector::BeatDetector(AudioAnalyzeFFT256 &fft)
+{
+    this->fft256_1 = &fft;
+
+    // every bin counts the same except dc, which the low band already covers and drifts with the music level
+    fluxWeights[0] = 0;
+    for (int i = 1; i < 128; i++)
+    {
+        fluxWeights[i] = 32767;
+    }
+}
+
+#ifdef BEAT_DETECTOR_FIXED_POINT
+uint32_t BeatDetector::bandInput(const BandConfig &band)
+{
+    uint32_t sum = 0;
+    for (int bin = band.firstBin; bin <= band.lastBin; bin++)
+    {
+        sum += fft256_1->output[bin];
+    }
+    return sum;
+}
+#endif
+
+bool BeatDetector::BeatDetectorLoop()
+{
+
+    lowBeat = 0; // reset these so they are only true for one cycle if set true on last loop.
+    midBeat = 0;
+    highBeat = 0;
+    for (int i = 0; i < NUM_BEAT_BANDS; i++)
+    {
+        beat[i] = 0;
+    }
+    onsetBeat = 0;
+
+    fftDataAvailable = false;
+
+    if (fft256_1->available()) // sizeof(SEND_DATA_STRUCTURE))   //&&peakMsecs>PEAK_MSECS_INTERVAL)
+    {
+        fftDataAvailable = true;
+        fftCount++; // increment fftCount to keep track of number of samples per second. Using for debuggig.
+
+        // potValue=map(analogRead(POT_PIN),0,1023,0,127);
+        // peakMsecs=0;
+
+        for (int i = 0; i < NUM_BEAT_BANDS; i++)
+        {
+            beat[i] = bands[i].update(bandInput(BEAT_BANDS[i]));
+        }
+        lowBeat = beat[LOW_BAND];
+        midBeat = beat[MID_BAND];
+        highBeat = beat[HIGH_BAND];
+
+        if (enableSpectralFlux)
+        {
+            uint32_t flux = spectralFlux(fft256_1->output, previousBins, fluxWeights, 128);
+            onsetStrength = flux * (1.0 / 16384.0);
+#ifdef BEAT_DETECTOR_FIXED_POINT
+            onsetInput = flux;
+#else
+            onsetInput = onsetStrength;
+#endif
+            onsetBeat = fluxBand.update(onsetInput);
+        }
+
+        if (enableSerialBeatDisplay)
+        {
+            // binary records into the telemetry ring, sent later by sendTelemetry()
+            TelemetryRecord record;
+            record.micros = micros();
+            record.frame = (uint16_t)telemetryFrame++;
+            for (int i = 0; i < NUM_BEAT_BANDS; i++)
+            {
+                bands[i].telemetry(record);
+                record.band = i;
+                record.flags |= beat[i] ? TELEMETRY_BEAT : 0;
+                telemetry.push(record);
+            }
+            if (enableSpectralFlux)
+            {
+                fluxBand.telemetry(record);
+                record.band = TELEMETRY_ONSET;
+                record.flags |= onsetBeat ? TELEMETRY_BEAT : 0;
+                telemetry.push(record);
+            }
+        }
+
+        // onset envelope: spectral flux plus how much louder the low band got, kick drums live mostly
+        // in bin 0 which the flux leaves out
+        float lowRise = bands[LOW_BAND].level() - previousLowValue;
+        previousLowValue = bands[LOW_BAND].level();
+        tempoTracker.update(onsetStrength + (lowRise > 0 ? lowRise : 0));
+
+        tempo = tempoTracker.tempo;
+        tempoConfidence = tempoTracker.confidence;
+        validBPM = tempo > 0 && tempoConfidence >= minTempoConfidence;
+        bpm = validBPM ? (uint8_t)(tempo + 0.5) : 0;
+        beatClock.setTempo(validBPM ? tempo : 0);
+
+        if (lowBeat /*||midBeat||highBeat*/)
+        {
+            beatCountTime = beatCountTimer; // store the current beatCount time so reading doesn't include the time it takes to do other code here. probably not significant
+            beatCountTimer = 0;             // reset beat count timer
+
+            if (beatCount < beatsRequired) // increment beat counter
+            {
+#ifdef SERIAL_BPM
+                Serial.print("Not enough beats only : ");
+                Serial.print(beatCount);
+                Serial.print("/");
+                Serial.println(beatsRequired);
+#endif
+                beatCount++;
+            }
+
+            musicPlayingStatusTime = 0; // reset this timer as manual music status update wont be needed as this info is sent along with beat detected message
+            // txdata.deviceNumber=1; //number 1 for led teensy
+            // txdata.commandNumber=COMMAND::beatDetected;
+
+            // commandData will be already set from nextion popcallback function
+            // txdata.fftLowBeat=lowBeat;
+            // txdata.fftMidBeat=bpm; // 0 if invalid bpm so receiving teensy can ignore it
+#ifdef SERIAL_BPM
+            Serial.print("BPM: ");
+            Serial.print(tempo);
+            Serial.print(" confidence: ");
+            Serial.println(tempoConfidence);
+#endif
+            // txdata.fftHighBeat=highBeat;
+            // txdata.rms1=rms1.read();
+            // txdata.sendCount=txdata.sendCount+1;
+            // txdata.commandData=musicPlaying;
+            // ETout.sendData();
+            // digitalWrite(13,!digitalRead(13));  //falsh board led every time message is sent
+        }
+    }
+
+    if (beatCountTimer > noBeatDuration) // no beats detected in last 2 seconds say
+    {
+        musicPlaying = false;
+        beatCount = 0;
+    }
+    else
+    {
+        if (beatCount == beatsRequired)
+        {
+            musicPlaying = true;
+        }
+    }
+
+    if (musicPlaying == false && musicWasPlaying == true) // detect when music changes from playing to not playing
+    {
+        musicStopped = true;
+    }
+    else
+    {
+        musicStopped = false;
+    }
+
+    musicWasPlaying = musicPlaying;
+    /*
+    Serial.print("beatcount");
+    Serial.println(beatCount);
+    Serial.print("musicPlaying");
+    Serial.println(musicPlaying);
+  */
+
+    uint32_t now = micros();
+    if (lowBeat)
+    {
+        beatClock.beatDetected(now - detectionLatency + lookahead); // when it will be heard
+    }
+
+    // with lookahead the flags wait until their audio is heard
+    if (lookahead > detectionLatency)
+    {
+        if (fftDataAvailable)
+        {
+            beatDelay.push(now + lookahead - detectionLatency, beat, onsetBeat);
+        }
+        beatDelay.pop(now, beat, onsetBeat);
+        lowBeat = beat[LOW_BAND];
+        midBeat = beat[MID_BAND];
+        highBeat = beat[HIGH_BAND];
+    }
+
+    // while the beat clock runs the virtual beat follows its predicted beats,
+    // before that (no valid bpm yet) it mirrors low beat
+    bool beatDue = beatClock.running() ? beatClock.update(now) : lowBeat != 0;
+    if (beatDue && virtualBeatRetriggerTimer > virtualBeatRetriggerTime) // retrigger lockout to fix double pulse issue.
+    {
+        virtualBeat = true;
+        virtualBeatMicros = beatClock.running() ? beatClock.lastBeat : now + lookahead - beatFlagLatency();
+        virtualBeatRetriggerTimer = 0;
+    }
+    else
+    {
+        virtualBeat = false;
+    }
+
+    return fftDataAvailable;
+}
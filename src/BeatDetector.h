@@ -0,0 +1,156 @@
+/*
+ * This is my BeatDetector class
+ * When combined with the teensy audio libraries FFT object it detects low/med/high frequency beats in audio played.
+ *
+ * To use create a BeatDetector object passing it a pointer to an AudioAnalyzeFFT256 object created using the teensy audio library
+ * Once per loop call BeatDetectorLoop().
+ * To determine if beat was detected just check objects public variables lowBeat/midBeat/highBeat
+ */
+
+/*
+ * BEAT DETECTION ALGORITHYM:
+ * A running average of the magnitude of the fft signal is kept for each bin range in BandConfig.h (low/mid/high by default).
+ * The maximum magnitude of fft signal seen in the last second is kept as a rolling max next to it (see BandDetector.h)
+ * The differnce between average and max audio values is calculated and a beat detection threshold is set between these two values determined by a threshold factor that you can set.
+ * If the current audio signal is greater than this threshold then it is a beat.
+ * Retriggering of beat detection is locked out for a preset amount of time. (see variables somewhere below)
+ * set enableSerialBeatDisplay true, call sendTelemetry() in the loop and use tools/telemetry.py to visualise whats going on.
+ *
+ * TEMPO:
+ * Every fft frame the onset envelope (spectral flux plus the rise of the low band) goes into a tempo tracker
+ * that autocorrelates the last few seconds of it. Its tempo and confidence give bpm/validBPM continuously
+ * instead of only when the last few beat intervals happen to agree.
+ *
+ * VIRTUAL BEAT:
+ * While a valid bpm is measured a phase locked beat clock runs at that tempo and is pulled into phase by every low beat
+ * (see BeatClock.h). virtualBeat comes from its predicted beat times and beatPhase() gives the position within the beat.
+ * Until a valid bpm is measured, virtualbeat will mirror low beat
+ *
+ * LOOKAHEAD:
+ * If the audio output is delayed behind what the fft gets (main.cpp puts a delay line in front of the i2s output),
+ * set lookahead to that delay. Beats are then found before they are heard: the beat flags wait in a BeatDelay until the
+ * audio they came from reaches the speakers and the beat clock is locked to when beats are heard, not when they were detected.
+ *
+ */
+
+#ifndef BEATDETECTOR_H
+#define BEATDETECTOR_H
+
+#include <Audio.h>
+#include <array>
+#include <utility>
+#include "BandConfig.h"
+#include "BandDetector.h"
+#include "FixedBandDetector.h"
+#include "SpectralFlux.h"
+#include "TempoTracker.h"
+#include "BeatClock.h"
+#include "BeatDelay.h"
+#include "Telemetry.h"
+
+class BeatDetector
+{
+public:
+    AudioAnalyzeFFT256 *fft256_1;       // pointer to fft object from audio library
+    BeatDetector(AudioAnalyzeFFT256 &); // constructor takes a refernce to get fft data from audio library
+    bool BeatDetectorLoop();            // method to call in programs loop to perform beat detection
+
+    // position within the current beat right now: 0 on the beat, up to 255 just before the next one.
+    // follows the phase locked beat clock, so unlike virtualBeat it doesn't depend on when the loop runs.
+    uint8_t beatPhase() { return beatClock.phase(micros()); }
+    bool beatPhaseValid() { return beatClock.running(); } // false until there is a valid bpm and a beat to lock to
+    uint32_t nextBeatMicros() { return beatClock.nextBeat; } // predicted time of the next beat, micros()
+
+    // for beats that don't come from the live fft (BeatMap): put the beat clock on a known beat at the current tempo
+    void syncBeatClock(uint32_t beatMicros) { beatClock.setBeat(beatMicros, tempo); }
+
+    float lowBeat = 0;             // non-zero if low frequency beat was detected after last BeatDetectorLoop was run. value was going to be beat level or something but I haven't done that yet.
+    float midBeat = 0;             // yada
+    float highBeat = 0;            // yadaYada
+    float onsetBeat = 0;           // non-zero if the spectral flux detector saw an onset in any bin (snare, hi-hat... that the bands miss)
+    float beat[NUM_BEAT_BANDS] = {}; // same for every band in BEAT_BANDS (BandConfig.h), lowBeat/midBeat/highBeat are the first three
+    bool virtualBeat = false;      // virtual beat generated by the beat clock, true for one loop after each predicted beat
+    uint32_t virtualBeatMicros = 0; // predicted time of the last virtual beat, micros(). virtualBeat is raised a loop later, this is when the beat really was
+    bool musicStopped = false;     // if music has changed from paying to stopped this flag is true for one scan
+    bool musicPlaying = false;     // True if music has been detected as playing
+    bool validBPM = false;         // true if a valid bpm is currently detected (tempoConfidence >= minTempoConfidence).
+    bool fftDataAvailable = false; // program that is using beatDetector may want to access raw fft data
+                                   // so I pass a flag to show when new data is available.
+    uint8_t bpm = 0;                      // beats per minute that are detected, rounded tempo. value of 0 is used for invalid reading
+    float tempo = 0;                      // continuous tempo estimate in beats per minute, keeps its last value when the music gets unclear
+    float tempoConfidence = 0;            // 0..1, how periodic the music was over the last few seconds
+    float minTempoConfidence = 0.2;       // tempoConfidence needed for validBPM
+    bool enableSerialBeatDisplay = false; // set true to record every band's average/max/threshold/value into telemetry each fft frame
+    Telemetry telemetry;                  // binary beat detection telemetry, see Telemetry.h and tools/telemetry.py
+    void sendTelemetry() { telemetry.drain(Serial); } // call from the loop when there's time, sends what Serial takes without blocking
+    uint32_t fftCount = 0;                // number of fft samples made in last second
+
+    bool enableSpectralFlux = true; // run the spectral flux onset detector over all 128 fft bins every fft frame
+    float onsetStrength = 0;        // spectral flux of the last fft frame, same scale as fft256_1->read()
+    alignas(4) int16_t fluxWeights[128]; // Q15 weight of each bin in the spectral flux sum (32767 = 1.0), see SpectralFlux.h
+
+    uint32_t detectionLatency = 5800; // us between a beat in the audio and lowBeat: half of the 3 x 128 + 128 samples behind an averaged fft frame
+    uint32_t lookahead = 0;           // us the audio output is behind the audio the fft gets. beat flags are held back to line up with the output
+
+    // us between a beat in the audio the fft gets and its flags. detectionLatency, or lookahead when that's longer
+    uint32_t beatFlagLatency() { return lookahead > detectionLatency ? lookahead : detectionLatency; }
+
+private:
+    elapsedMillis musicPlayingStatusTime = 0; // music playin status update will be sent a regular intervals below.
+    const int musicPlayingStatusInterval = 5000;
+
+    // I need to determine if music is playing or rather if beats are being detected
+    // I could do this by listening for a beat and if none heard for a period of:
+    uint32_t noBeatDuration = 3000;
+
+    elapsedMillis beatCountTimer = 0; // timer for above nobeatduration
+    uint32_t beatCountTime = 0;
+    BeatClock beatClock;                         // phase locked to the low beats, runs at the tracked tempo
+    BeatDelay beatDelay;                         // beat flags waiting for their audio to be heard, see lookahead
+    elapsedMillis virtualBeatRetriggerTimer = 0; // timer to lock out double pulses when using virtualBeat
+    uint32_t virtualBeatRetriggerTime = 200;     // minimum time between virtual beats using timer above.
+    // Then I clear a varialbe to say music is not playing:
+
+    bool musicWasPlaying = false; // old status of music used to tell when state changes and updates variable below
+
+    // if however a beat is detected I don't want to count 1 lone random noise generated beat as music playing.
+
+    // I will do this by incrementing a beatCount variable:
+    uint32_t beatCount = 0; //(this beatCount variable will be zero'd when above noBeatDuration is reached.
+    // and checking when it reaches a preset amount:
+    uint8_t beatsRequired = 2;
+
+    // beats per minute come from the tempo tracker, which autocorrelates the onset envelope over the last few seconds (see TempoTracker.h)
+    TempoTracker tempoTracker{AUDIO_SAMPLE_RATE_EXACT / (AUDIO_BLOCK_SAMPLES * 3)}; // fft frame rate with averageTogether(3)
+    float previousLowValue = 0;                                                       // for the low band part of the onset envelope
+
+    //***************************************************************************************************************************************************************
+    //***************************************************************************************************************************************************************
+    // one detector per line of BEAT_BANDS (BandConfig.h), built at compile time.
+    // build with -D BEAT_DETECTOR_FIXED_POINT for the integer version working on raw fft magnitudes
+#ifdef BEAT_DETECTOR_FIXED_POINT
+    typedef FixedBandDetector<MAX_BAND_WINDOW> Band;
+    uint32_t bandInput(const BandConfig &band); // raw magnitude sum over the band's bins
+    uint32_t onsetInput;                        // raw spectral flux of the last frame
+#else
+    typedef BandDetector<MAX_BAND_WINDOW> Band;
+    float bandInput(const BandConfig &band) { return fft256_1->read(band.firstBin, band.lastBin); }
+    float onsetInput;
+#endif
+    template <size_t... I>
+    static std::array<Band, NUM_BEAT_BANDS> makeBands(std::index_sequence<I...>) { return {{Band(BEAT_BANDS[I])...}}; }
+    std::array<Band, NUM_BEAT_BANDS> bands = makeBands(std::make_index_sequence<NUM_BEAT_BANDS>());
+
+    // spectral flux onset detection. flux of every frame goes through its own BandDetector for the threshold
+    alignas(4) uint16_t previousBins[128] = {}; // fft magnitudes of the previous frame
+    Band fluxBand{ONSET_BAND};
+
+    uint32_t telemetryFrame = 0; // fft frames recorded, TelemetryRecord::frame
+
+    // bools to enable/dissable plotting of beat detection variables to nextion hmi
+    uint32_t enablePlot0 = 0; // first value to plot (selected from checkbox on nextion)
+    uint32_t enablePlot1 = 0;
+    uint32_t enablePlot2 = 0;
+    uint32_t enablePlot3 = 0;
+};
+#endif // BeatDetector_H
\ No newline at end of file
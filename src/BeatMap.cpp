@@ -0,0 +1,148 @@
+#include "BeatMap.h"
+#include "Sidecar.h"
+
+bool BeatMap::open(const char *wavFilename)
+{
+    close();
+
+    // song.wav -> song.beats
+    char name[64];
+    sidecarName(wavFilename, ".beats", name, sizeof(name));
+
+    if (!openSidecar(file, name))
+    {
+        return false;
+    }
+
+    BeatMapHeader header;
+    int bytes = sidecarRead(file, &header, sizeof(header));
+    if (bytes != sizeof(header) || memcmp(header.magic, BEATMAP_MAGIC, 4) || header.version != BEATMAP_VERSION)
+    {
+        Serial.print(name);
+        Serial.println(" is not a beat map");
+        sidecarClose(file);
+        return false;
+    }
+
+    sampleRate = header.sampleRate;
+    eventCount = header.eventCount;
+    eventsLeft = eventCount;
+    buffered = 0;
+    bufferIndex = 0;
+    havePending = nextEvent(pending);
+    opened = true;
+    return true;
+}
+
+void BeatMap::close()
+{
+    if (opened)
+    {
+        sidecarClose(file);
+    }
+    opened = false;
+    havePending = false;
+}
+
+bool BeatMap::nextEvent(BeatMapEvent &event)
+{
+    if (bufferIndex >= buffered)
+    {
+        int count = eventsLeft < BUFFERED_EVENTS ? eventsLeft : BUFFERED_EVENTS;
+        if (count == 0)
+        {
+            return false;
+        }
+        int bytes = sidecarRead(file, buffer, count * sizeof(BeatMapEvent));
+        buffered = bytes / sizeof(BeatMapEvent);
+        bufferIndex = 0;
+        eventsLeft -= buffered;
+        if (buffered == 0)
+        {
+            eventsLeft = 0;
+            return false;
+        }
+    }
+    event = buffer[bufferIndex++];
+    return true;
+}
+
+void BeatMap::clearBeats(BeatDetector &detector)
+{
+    detector.lowBeat = 0;
+    detector.midBeat = 0;
+    detector.highBeat = 0;
+    detector.onsetBeat = 0;
+    detector.virtualBeat = false;
+}
+
+void BeatMap::seek(uint32_t positionMillis, BeatDetector &detector)
+{
+    if (!opened)
+    {
+        return;
+    }
+
+    // from the start, the map is small enough to read through (8 bytes per beat)
+    sidecarSeek(file, sizeof(BeatMapHeader));
+    eventsLeft = eventCount;
+    buffered = 0;
+    bufferIndex = 0;
+    havePending = nextEvent(pending);
+
+    update(positionMillis, detector);
+    clearBeats(detector); // those were before the jump
+}
+
+void BeatMap::update(uint32_t positionMillis, BeatDetector &detector)
+{
+    clearBeats(detector);
+
+    uint32_t now = micros();
+    uint32_t position = (uint32_t)((uint64_t)positionMillis * sampleRate / 1000);
+
+    // everything the song passed since the last loop
+    while (havePending && pending.sample <= position)
+    {
+        float strength = pending.strength * (1.0 / 255.0);
+        if (strength == 0)
+        {
+            strength = 1.0 / 255.0; // beat flags must be non-zero
+        }
+
+        if (pending.type & BEATMAP_TEMPO)
+        {
+            detector.tempo = pending.value * 0.01;
+            detector.tempoConfidence = pending.strength * (1.0 / 255.0);
+            detector.validBPM = detector.tempo > 0 && detector.tempoConfidence >= detector.minTempoConfidence;
+            detector.bpm = detector.validBPM ? (uint8_t)(detector.tempo + 0.5) : 0;
+            detector.musicPlaying = detector.validBPM;
+        }
+        if (pending.type & BEATMAP_LOW)
+        {
+            detector.lowBeat = strength;
+        }
+        if (pending.type & BEATMAP_MID)
+        {
+            detector.midBeat = strength;
+        }
+        if (pending.type & BEATMAP_HIGH)
+        {
+            detector.highBeat = strength;
+        }
+        if (pending.type & BEATMAP_ONSET)
+        {
+            detector.onsetBeat = strength;
+        }
+        if (pending.type & BEATMAP_VIRTUAL)
+        {
+            // the beat was (position - sample) samples ago
+            uint32_t beatMicros = now - (uint32_t)((uint64_t)(position - pending.sample) * 1000000 / sampleRate);
+            detector.virtualBeat = true;
+            detector.virtualBeatMicros = beatMicros;
+            detector.syncBeatClock(beatMicros);
+        }
+
+        havePending = nextEvent(pending);
+    }
+}
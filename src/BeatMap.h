@@ -0,0 +1,53 @@
+/*
+ * Plays back a precomputed .beats sidecar file (see BeatMapFormat.h) next to the wav.
+ *
+ * Instead of running the fft beat detection live, update() is called once per loop with
+ * the playback position and raises the same lowBeat/midBeat/highBeat/onsetBeat/virtualBeat
+ * flags on the BeatDetector when the song reaches each beat, sets tempo/bpm from the
+ * tempo events and keeps the beat clock locked to the map's virtual beats, so patterns
+ * don't notice where the beats came from.
+ *
+ * The file is streamed a few events at a time so RAM use doesn't depend on the song length.
+ */
+
+#ifndef BEATMAP_H
+#define BEATMAP_H
+
+#include <SD.h>
+#include "BeatDetector.h"
+#include "BeatMapFormat.h"
+
+class BeatMap
+{
+public:
+    bool open(const char *wavFilename); // opens the sidecar of wavFilename (song.wav -> song.beats), false if there is none
+    void close();
+    bool isOpen() { return opened; }
+
+    // call once per loop instead of BeatDetectorLoop(). positionMillis is playSdWav1.positionMillis()
+    void update(uint32_t positionMillis, BeatDetector &detector);
+
+    // after the song jumped to positionMillis: reads the map up to there so tempo and beat clock are
+    // what they would be, without raising the beat flags of the beats skipped
+    void seek(uint32_t positionMillis, BeatDetector &detector);
+
+private:
+    bool nextEvent(BeatMapEvent &event); // false at the end of the map
+    void clearBeats(BeatDetector &detector);
+
+    File file;
+    bool opened = false;
+    uint32_t sampleRate = 44100;
+    uint32_t eventCount = 0;
+    uint32_t eventsLeft = 0; // still in the file
+
+    static const int BUFFERED_EVENTS = 16;
+    BeatMapEvent buffer[BUFFERED_EVENTS];
+    int buffered = 0;
+    int bufferIndex = 0;
+
+    BeatMapEvent pending; // next event, not reached yet
+    bool havePending = false;
+};
+
+#endif // BEATMAP_H
@@ -0,0 +1,51 @@
+/*
+ * .beats sidecar file format, shared by the host tool that writes it (src/host/replay.cpp -w)
+ * and BeatMap which plays it back on the teensy.
+ *
+ * A beat map is the beat detector's output for one song, computed once offline:
+ *
+ *   BeatMapHeader
+ *   BeatMapEvent[eventCount]  sorted by sample position
+ *
+ * Beats and tempo changes share one event stream so the player only has to read the
+ * file front to back. Everything is little endian (teensy and x86 both are).
+ * The sample position is where the beat is in the audio, detection latency already removed.
+ */
+
+#ifndef BEATMAPFORMAT_H
+#define BEATMAPFORMAT_H
+
+#include <stdint.h>
+
+#define BEATMAP_MAGIC "BMAP"
+#define BEATMAP_VERSION 1
+
+// event types, beat types can be or'ed together when they happen at the same sample
+#define BEATMAP_LOW 0x01
+#define BEATMAP_MID 0x02
+#define BEATMAP_HIGH 0x04
+#define BEATMAP_ONSET 0x08
+#define BEATMAP_VIRTUAL 0x10
+#define BEATMAP_TEMPO 0x80 // tempo change, value = bpm * 100, strength = confidence * 255
+
+struct BeatMapHeader
+{
+    char magic[4];       // BEATMAP_MAGIC
+    uint16_t version;    // BEATMAP_VERSION
+    uint16_t reserved;
+    uint32_t sampleRate; // of the wav the map was made from
+    uint32_t eventCount;
+};
+
+struct BeatMapEvent
+{
+    uint32_t sample;  // position in the song
+    uint8_t type;     // BEATMAP_ flags
+    uint8_t strength; // beat level, 0..255 (band magnitude * 255, clipped)
+    uint16_t value;   // bpm * 100 for BEATMAP_TEMPO
+};
+
+static_assert(sizeof(BeatMapHeader) == 16, "BeatMapHeader must be packed");
+static_assert(sizeof(BeatMapEvent) == 8, "BeatMapEvent must be packed");
+
+#endif // BEATMAPFORMAT_H
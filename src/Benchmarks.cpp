@@ -0,0 +1,238 @@
+#ifdef BEATBUZZER_BENCH
+
+#include <Arduino.h>
+#include "Benchmarks.h"
+#include "BandDetector.h"
+#include "CTeensy4Controller.h"
+#include "FixedBandDetector.h"
+#include "Patterns.h"
+
+// fake fft frames: a bit of noise in every bin and a kick in the low bins every 57 frames (120 bpm)
+static const int BENCH_FRAMES = 1024;
+static const uint32_t FFT_FRAME_MICROS = 1000000.0 * 3 * AUDIO_BLOCK_SAMPLES / AUDIO_SAMPLE_RATE_EXACT; // averageTogether(3)
+static uint16_t benchBins(int frame, int bin)
+{
+    uint32_t noise = (frame * 2654435761u + bin * 40503u) >> 24;
+    bool kick = frame % 57 < 3 && bin < 4;
+    return noise * 4 + (kick ? 8000 : 0);
+}
+
+static void benchmarkBands()
+{
+    BandDetector<MAX_BAND_WINDOW> *floatBands[NUM_BEAT_BANDS];
+    FixedBandDetector<MAX_BAND_WINDOW> *fixedBands[NUM_BEAT_BANDS];
+    for (int i = 0; i < NUM_BEAT_BANDS; i++)
+    {
+        floatBands[i] = new BandDetector<MAX_BAND_WINDOW>(BEAT_BANDS[i]);
+        fixedBands[i] = new FixedBandDetector<MAX_BAND_WINDOW>(BEAT_BANDS[i]);
+    }
+
+    uint32_t cycles[2] = {0, 0};
+    uint32_t beats[2] = {0, 0};
+    uint32_t differences = 0;
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        uint32_t sums[NUM_BEAT_BANDS];
+        for (int i = 0; i < NUM_BEAT_BANDS; i++)
+        {
+            sums[i] = 0;
+            for (int bin = BEAT_BANDS[i].firstBin; bin <= BEAT_BANDS[i].lastBin; bin++)
+            {
+                sums[i] += benchBins(frame, bin);
+            }
+        }
+
+        // same input conversion BeatDetector does: read() is the sum / 16384
+        bool fired[2][NUM_BEAT_BANDS];
+        uint32_t start = ARM_DWT_CYCCNT;
+        for (int i = 0; i < NUM_BEAT_BANDS; i++)
+        {
+            fired[0][i] = floatBands[i]->update(sums[i] * (1.0f / 16384.0f)) != 0;
+        }
+        cycles[0] += ARM_DWT_CYCCNT - start;
+
+        start = ARM_DWT_CYCCNT;
+        for (int i = 0; i < NUM_BEAT_BANDS; i++)
+        {
+            fired[1][i] = fixedBands[i]->update(sums[i]) != 0;
+        }
+        cycles[1] += ARM_DWT_CYCCNT - start;
+
+        for (int i = 0; i < NUM_BEAT_BANDS; i++)
+        {
+            beats[0] += fired[0][i];
+            beats[1] += fired[1][i];
+            differences += fired[0][i] != fired[1][i];
+        }
+
+        // the retrigger timers are elapsedMillis, frames have to come at the real fft rate
+        // or every beat after the first falls inside retriggerTime
+        delayMicroseconds(FFT_FRAME_MICROS);
+    }
+
+    Serial.printf("band detection, %d bands: float %u cycles/frame, fixed point %u cycles/frame (%u / %u beats%s)\n",
+                  NUM_BEAT_BANDS, cycles[0] / BENCH_FRAMES, cycles[1] / BENCH_FRAMES, beats[0], beats[1],
+                  differences ? ", BEATS DIFFER" : "");
+
+    for (int i = 0; i < NUM_BEAT_BANDS; i++)
+    {
+        delete floatBands[i];
+        delete fixedBands[i];
+    }
+}
+
+// showPixels() without the show() at the end, which waits for the dma: setPixel() for every
+// led like it used to against CTeensy4Controller::writePixels()
+static void benchmarkLedOutput()
+{
+    const int ROUNDS = 16;
+    const int ledCounts[] = {120, 960, 4800};
+    for (int count : ledCounts)
+    {
+        CRGB *pixels = new CRGB[count];
+        uint32_t *frameMemory = new uint32_t[(count * 3 + 3) / 4];
+        uint32_t *drawMemory = new uint32_t[(count * 3 + 3) / 4];
+        for (int i = 0; i < count; i++)
+        {
+            pixels[i] = CHSV(i * 7, 255, 200);
+        }
+        uint8_t pin = 2;
+        OctoWS2811 octo(count, frameMemory, drawMemory, WS2811_GRB | WS2811_800kHz, 1, &pin);
+        CRGB scale(200, 200, 200);
+
+        uint32_t cycles[2] = {0, 0};
+        for (int round = 0; round < ROUNDS; round++)
+        {
+            PixelController<GRB, 8, 0xFF> oneByOne(pixels, count, scale, BINARY_DITHER);
+            uint32_t start = ARM_DWT_CYCCNT;
+            uint32_t i = 0;
+            while (oneByOne.has(1))
+            {
+                uint8_t g = oneByOne.loadAndScale0();
+                uint8_t r = oneByOne.loadAndScale1();
+                uint8_t b = oneByOne.loadAndScale2();
+                octo.setPixel(i++, r, g, b);
+                oneByOne.stepDithering();
+                oneByOne.advanceData();
+            }
+            cycles[0] += ARM_DWT_CYCCNT - start;
+
+            PixelController<GRB, 8, 0xFF> bulk(pixels, count, scale, BINARY_DITHER);
+            start = ARM_DWT_CYCCNT;
+            CTeensy4Controller<GRB, WS2811_800kHz>::writePixels(bulk, drawMemory);
+            cycles[1] += ARM_DWT_CYCCNT - start;
+        }
+
+        Serial.printf("led output, %d leds: setPixel %u cycles, bulk %u cycles (%u / %u per 100 leds)\n", count,
+                      cycles[0] / ROUNDS, cycles[1] / ROUNDS, cycles[0] / ROUNDS * 100 / count, cycles[1] / ROUNDS * 100 / count);
+
+        delete[] pixels;
+        delete[] frameMemory;
+        delete[] drawMemory;
+    }
+}
+
+// The colour loops of bpm(), pulsing(), fillGradual() and wiggleLines() over all leds, once
+// with ColorFromPalette() like they used to and once from gPartyColors, for the same frames
+static const int PATTERN_FRAMES = 256;
+static CRGB patternLeds[2][NUM_LEDS];
+
+static void benchmarkPattern(const char *name, void (*before)(CRGB *, uint8_t), void (*after)(CRGB *, uint8_t))
+{
+    uint32_t cycles[2] = {0, 0};
+    uint32_t differences = 0;
+    for (int frame = 0; frame < PATTERN_FRAMES; frame++)
+    {
+        uint32_t start = ARM_DWT_CYCCNT;
+        before(patternLeds[0], frame);
+        cycles[0] += ARM_DWT_CYCCNT - start;
+
+        start = ARM_DWT_CYCCNT;
+        after(patternLeds[1], frame);
+        cycles[1] += ARM_DWT_CYCCNT - start;
+
+        differences += memcmp(patternLeds[0], patternLeds[1], sizeof(patternLeds[0])) != 0;
+    }
+    Serial.printf("%s, %d leds: ColorFromPalette %u cycles/frame, palette cache %u cycles/frame%s\n", name, NUM_LEDS,
+                  cycles[0] / PATTERN_FRAMES, cycles[1] / PATTERN_FRAMES, differences ? ", FRAMES DIFFER" : "");
+}
+
+static void benchmarkPatterns()
+{
+    // frame stands in for gHue and the beat
+    benchmarkPattern(
+        "bpm",
+        [](CRGB *out, uint8_t frame) {
+            CRGBPalette16 palette = PartyColors_p;
+            for (int i = 0; i < NUM_LEDS; i++)
+            {
+                out[i] = ColorFromPalette(palette, frame + (i * 2), frame * 3 - frame + (i * 10));
+            }
+        },
+        [](CRGB *out, uint8_t frame) {
+            for (int i = 0; i < NUM_LEDS; i++)
+            {
+                out[i] = gPartyColors.color(frame + (i * 2), frame * 3 - frame + (i * 10));
+            }
+        });
+    benchmarkPattern(
+        "pulsing",
+        [](CRGB *out, uint8_t frame) {
+            CRGBPalette16 palette = PartyColors_p;
+            for (int i = 0; i < NUM_LEDS; i++)
+            {
+                out[i] = ColorFromPalette(palette, frame + (i * 2), scale8(frame + (i * 10), 255 - frame));
+            }
+        },
+        [](CRGB *out, uint8_t frame) {
+            for (int i = 0; i < NUM_LEDS; i++)
+            {
+                out[i] = gPartyColors.color(frame + (i * 2), scale8(frame + (i * 10), 255 - frame));
+            }
+        });
+    benchmarkPattern(
+        "fillGradual",
+        [](CRGB *out, uint8_t frame) {
+            CRGBPalette16 palette = PartyColors_p;
+            for (int i = 0; i < NUM_LEDS; i++)
+            {
+                out[i] = ColorFromPalette(palette, frame, 120);
+            }
+        },
+        [](CRGB *out, uint8_t frame) {
+            CRGB color = gPartyColors.color(frame, 120);
+            for (int i = 0; i < NUM_LEDS; i++)
+            {
+                out[i] = color;
+            }
+        });
+    benchmarkPattern(
+        "wiggleLines",
+        [](CRGB *out, uint8_t frame) {
+            CRGBPalette16 palette = PartyColors_p;
+            for (int i = 0; i < NUM_LEDS; i++)
+            {
+                out[i] = ColorFromPalette(palette, frame, 255 - 10 * (i % 10));
+            }
+        },
+        [](CRGB *out, uint8_t frame) {
+            for (int i = 0; i < NUM_LEDS; i++)
+            {
+                out[i] = gPartyColors.color(frame, 255 - 10 * (i % 10));
+            }
+        });
+}
+
+void runBenchmarks()
+{
+    while (!Serial && millis() < 3000)
+    {
+        // wait for the serial monitor
+    }
+    Serial.println("BeatBuzzer benchmarks");
+    benchmarkBands();
+    benchmarkLedOutput();
+    benchmarkPatterns();
+}
+
+#endif // BEATBUZZER_BENCH
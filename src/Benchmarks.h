@@ -0,0 +1,14 @@
+/*
+ * On-device cycle benchmarks, only built with -D BEATBUZZER_BENCH (pio run -e teensy40_bench).
+ * runBenchmarks() is called at the end of setup(), prints its results to Serial and returns.
+ * Cycles come from the Cortex-M7 cycle counter (ARM_DWT_CYCCNT, 600 cycles per us).
+ */
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#ifdef BEATBUZZER_BENCH
+void runBenchmarks();
+#endif
+
+#endif // BENCHMARKS_H
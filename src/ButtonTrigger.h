@@ -0,0 +1,66 @@
+/*
+ * The buzzer button on a pin interrupt instead of polled with Bounce once per loop.
+ *
+ * Polled, a press waited for whatever the loop was busy with (a frame, an sd card read)
+ * and then for the next 10 ms Bounce interval, so the song started anywhere from right
+ * away to 15 ms later. The interrupt sees the edge when it happens and takes micros()
+ * right there, which is also the timestamp the latency probe measures from.
+ *
+ * Debounced in the interrupt: a press is a falling edge after the pin was high for
+ * DEBOUNCE_MICROS. The contacts bouncing on press and on release make edges close
+ * to each other, none of them counts.
+ */
+
+#ifndef BUTTONTRIGGER_H
+#define BUTTONTRIGGER_H
+
+#include <Arduino.h>
+
+class ButtonTrigger
+{
+public:
+    static const uint32_t DEBOUNCE_MICROS = 10000;
+
+    // from the pin interrupt, on every edge. true when it is a press
+    bool edge(bool pressed, uint32_t nowMicros)
+    {
+        bool settled = nowMicros - lastEdge >= DEBOUNCE_MICROS;
+        lastEdge = nowMicros;
+        if (!pressed || !settled)
+        {
+            return false;
+        }
+        pressMicros = nowMicros;
+        pending = true;
+        return true;
+    }
+
+    // from the pin interrupt, it started the song for the last press
+    void startedSong() { started = true; }
+
+    // a press since the last call, with micros() of the edge and whether the interrupt
+    // already started a song for it. for the loop
+    bool takePress(uint32_t &pressedMicros, bool &songStarted)
+    {
+        noInterrupts();
+        bool was = pending;
+        pressedMicros = pressMicros;
+        songStarted = started;
+        pending = false;
+        started = false;
+        interrupts();
+        return was;
+    }
+
+    // set by the loop when the interrupt may start the song itself (WavPlayer::playPreloaded()).
+    // cleared before the loop touches the player, the interrupt clears it when it starts one
+    volatile bool armed = false;
+
+private:
+    volatile uint32_t lastEdge = 0;
+    volatile uint32_t pressMicros = 0;
+    volatile bool pending = false;
+    volatile bool started = false;
+};
+
+#endif // BUTTONTRIGGER_H
@@ -1,3 +1,27 @@
+/*
+ * FastLED output through OctoWS2811 on the Teensy 4.
+ *
+ * FastLED hands showPixels() the leds to be scaled by the brightness and dithered, a byte
+ * at a time. On the Teensy 4 OctoWS2811's drawing memory holds the pixels as plain bytes
+ * in the order they go out on the wire, strip after strip: show() copies it and the DMA
+ * does the bit transposing while it sends. setPixel() for every led packed the colour into
+ * an int, reordered it for the config and unpacked it again, so instead showPixels() stores
+ * FastLED's bytes straight into the drawing memory, four leds at a time as three words.
+ *
+ * The bytes go out in FastLED's RGB_ORDER, which has to be the order of the OctoWS2811
+ * config (GRB for WS2811_GRB). 3 bytes per led, not for RGBW.
+ *
+ * showPixels() doesn't wait for the frame before to be out on the wire either, which is
+ * what pocto->show() does first. The drawing memory isn't what the dma sends, so the new
+ * frame goes in there right away and is handed over by present() once the wire is free,
+ * called from the loop. Rendering the next frame overlaps with sending this one; a frame
+ * that is still waiting when the next is shown is replaced by it. visibleMicros() is when
+ * the newest frame is on the strip, for the frame scheduling.
+ */
+
+#ifndef CTEENSY4CONTROLLER_H
+#define CTEENSY4CONTROLLER_H
+
 #include <OctoWS2811.h>
 #include <FastLED.h>
 #include <Arduino.h>
@@ -6,27 +30,91 @@ template <EOrder RGB_ORDER = RGB,
           uint8_t CHIP = WS2811_800kHz>
 class CTeensy4Controller : public CPixelLEDController<RGB_ORDER, 8, 0xFF>
 {
+    static const uint32_t RESET_MICROS = 300; // between two frames on the wire
+
     OctoWS2811 *pocto;
+    uint32_t *drawing;   // pocto's drawing memory
+    uint32_t wireMicros; // sending one frame
+    bool pending = false; // a frame in drawing that pocto hasn't got yet
+    uint32_t visibleAt = 0;
 
 public:
-    CTeensy4Controller(OctoWS2811 *_pocto)
-        : pocto(_pocto){};
+    CTeensy4Controller(OctoWS2811 *_pocto, void *drawingMemory, uint32_t ledsPerStrip)
+        : pocto(_pocto), drawing((uint32_t *)drawingMemory), wireMicros(ledsPerStrip * (CHIP == WS2811_400kHz ? 60 : 30)){};
 
     virtual void init() {}
     virtual void showPixels(PixelController<RGB_ORDER, 8, 0xFF> &pixels)
     {
+        writePixels(pixels, drawing);
+        pending = true;
+        present();
+    }
+
+    // sends the frame waiting in the drawing memory if the one before is out. true if it did
+    bool present()
+    {
+        if (!pending || pocto->busy())
+        {
+            return false;
+        }
+        pocto->show();
+        pending = false;
+        visibleAt = micros() + wireMicros;
+        return true;
+    }
+
+    bool isPending() const { return pending; }
+
+    // micros() when the newest frame is all on the strip, an estimate while it is pending
+    uint32_t visibleMicros() const
+    {
+        if (!pending)
+        {
+            return visibleAt;
+        }
+        uint32_t now = micros();
+        uint32_t wireFree = visibleAt + RESET_MICROS;
+        return ((int32_t)(wireFree - now) > 0 ? wireFree : now) + wireMicros;
+    }
+
+    // scaled and dithered pixels into memory, 3 bytes per led in wire order. memory is 32 bit aligned
+    static void writePixels(PixelController<RGB_ORDER, 8, 0xFF> &pixels, uint32_t *memory)
+    {
+        while (pixels.has(4))
+        {
+            uint32_t a0 = pixels.loadAndScale0(), a1 = pixels.loadAndScale1(), a2 = pixels.loadAndScale2();
+            next(pixels);
+            uint32_t b0 = pixels.loadAndScale0(), b1 = pixels.loadAndScale1(), b2 = pixels.loadAndScale2();
+            next(pixels);
+            uint32_t c0 = pixels.loadAndScale0(), c1 = pixels.loadAndScale1(), c2 = pixels.loadAndScale2();
+            next(pixels);
+            uint32_t d0 = pixels.loadAndScale0(), d1 = pixels.loadAndScale1(), d2 = pixels.loadAndScale2();
+            next(pixels);
+            // little endian: the first byte in memory is the low byte of the word
+            memory[0] = a0 | a1 << 8 | a2 << 16 | b0 << 24;
+            memory[1] = b1 | b2 << 8 | c0 << 16 | c1 << 24;
+            memory[2] = c2 | d0 << 8 | d1 << 16 | d2 << 24;
+            memory += 3;
+        }
 
-        uint32_t i = 0;
+        // the last one to three leds of the strip
+        uint8_t *bytes = (uint8_t *)memory;
         while (pixels.has(1))
         {
-            uint8_t g = pixels.loadAndScale0();
-            uint8_t r = pixels.loadAndScale1();
-            uint8_t b = pixels.loadAndScale2();
-            pocto->setPixel(i++, r, g, b);
-            pixels.stepDithering();
-            pixels.advanceData();
+            bytes[0] = pixels.loadAndScale0();
+            bytes[1] = pixels.loadAndScale1();
+            bytes[2] = pixels.loadAndScale2();
+            bytes += 3;
+            next(pixels);
         }
+    }
 
-        pocto->show();
+private:
+    static void next(PixelController<RGB_ORDER, 8, 0xFF> &pixels)
+    {
+        pixels.stepDithering();
+        pixels.advanceData();
     }
-};
\ No newline at end of file
+};
+
+#endif // CTEENSY4CONTROLLER_H
@@ -0,0 +1,178 @@
+/*
+ * Transitions between show segments.
+ *
+ * Each FROM segment of a show (the FROM cues CuePlayer is running) draws into its own frame
+ * from a FramePool instead of straight into leds. When new FROM cues take over with a
+ * transition other than TRANSITION_CUT, the old segment keeps running in its frame for
+ * the length of the transition and leds gets the blend of both:
+ *
+ *   TRANSITION_FADE  linear crossfade over transitionLength x 10 ms
+ *   TRANSITION_BEAT  linear crossfade that ends on a beat, transitionLength beats long
+ *   TRANSITION_WIPE  the new segment takes over the strip from led 0 up, transitionLength x 10 ms
+ *
+ * Patterns still draw into leds: a segment's frame is copied into leds, the pattern runs,
+ * and the result is copied back, so they see their own last frame like before and need
+ * no changes. AT cues draw into the newest segment.
+ *
+ * Once per frame:
+ *   crossfader.beginFrame();
+ *   cuePlayer.advance(position, runCue);
+ *   crossfader.render(cuePlayer, runCue, position, beatDetector);
+ */
+
+#ifndef CROSSFADER_H
+#define CROSSFADER_H
+
+#include <FastLED.h>
+#include "BeatDetector.h"
+#include "CuePlayer.h"
+#include "FramePool.h"
+
+template <int NumLeds>
+class Crossfader
+{
+public:
+    Crossfader(CRGB *leds) : leds(leds) {}
+
+    // at the start of a song, before the first frame
+    void reset()
+    {
+        pool.releaseAll();
+        current.frame = nullptr;
+        outgoing.frame = nullptr;
+        segment = 0;
+    }
+
+    // before CuePlayer::advance(): puts the newest segment's own last frame back into leds
+    void beginFrame()
+    {
+        if (current.frame)
+        {
+            memcpy(leds, current.frame, sizeof(CRGB) * NumLeds);
+        }
+    }
+
+    // after CuePlayer::advance(): runs the current FROM cues, and the previous ones while a transition
+    // is going on, and leaves what is to be shown in leds
+    void render(const CuePlayer &player, CuePlayer::CueRunner run, uint32_t positionMillis, BeatDetector &beats)
+    {
+        if (player.segment() != segment)
+        {
+            startSegment(player, positionMillis, beats);
+        }
+        if (!current.frame)
+        {
+            return; // no FROM cue reached yet
+        }
+
+        for (int i = 0; i < current.count; i++)
+        {
+            run(current.cues[i]);
+        }
+        memcpy(current.frame, leds, sizeof(CRGB) * NumLeds);
+
+        if (!outgoing.frame)
+        {
+            return;
+        }
+        if ((int32_t)(positionMillis - transitionEnd) >= 0)
+        {
+            endTransition();
+            return;
+        }
+        uint8_t progress = (uint64_t)(positionMillis - transitionStart) * 256 / (transitionEnd - transitionStart);
+
+        memcpy(leds, outgoing.frame, sizeof(CRGB) * NumLeds);
+        for (int i = 0; i < outgoing.count; i++)
+        {
+            run(outgoing.cues[i]);
+        }
+        memcpy(outgoing.frame, leds, sizeof(CRGB) * NumLeds);
+
+        if (transition == TRANSITION_WIPE)
+        {
+            int wiped = progress * NumLeds / 256;
+            memcpy(leds, current.frame, sizeof(CRGB) * wiped);
+        }
+        else
+        {
+            blend(outgoing.frame, current.frame, leds, NumLeds, progress);
+        }
+    }
+
+    bool transitioning() const { return outgoing.frame != nullptr; }
+
+private:
+    struct Segment
+    {
+        CRGB *frame = nullptr; // from pool, nullptr if the segment isn't there
+        Cue cues[CuePlayer::MAX_FROM_CUES];
+        int count = 0;
+    };
+
+    void startSegment(const CuePlayer &player, uint32_t positionMillis, BeatDetector &beats)
+    {
+        segment = player.segment();
+        if (outgoing.frame)
+        {
+            endTransition(); // new cues in the middle of a transition: the oldest segment goes
+        }
+
+        const Cue &first = player.fromCues()[0];
+        transition = first.transition;
+        if (current.frame && transition != TRANSITION_CUT)
+        {
+            outgoing = current;
+            current.frame = pool.acquire();
+            if (!current.frame)
+            {
+                // can't happen with two frames, but cut rather than draw nowhere
+                current.frame = outgoing.frame;
+                outgoing.frame = nullptr;
+            }
+        }
+        else if (!current.frame)
+        {
+            current.frame = pool.acquire();
+        }
+
+        // the new segment starts from what the last one left on the strip, like it always did without transitions
+        memcpy(current.frame, leds, sizeof(CRGB) * NumLeds);
+        current.count = player.fromCueCount();
+        memcpy(current.cues, player.fromCues(), sizeof(Cue) * current.count);
+
+        transitionStart = positionMillis;
+        uint32_t length = first.transitionLength ? first.transitionLength : 1;
+        if (transition == TRANSITION_BEAT)
+        {
+            // to the end of this beat plus whole beats, 120 bpm until the beat clock runs
+            uint32_t period = beats.beatPhaseValid() && beats.tempo > 0 ? (uint32_t)(60000 / beats.tempo) : 500;
+            transitionEnd = positionMillis + (256 - beats.beatPhase()) * period / 256 + (length - 1) * period;
+        }
+        else
+        {
+            transitionEnd = positionMillis + length * 10;
+        }
+        if (transitionEnd == transitionStart)
+        {
+            transitionEnd++;
+        }
+    }
+
+    void endTransition()
+    {
+        pool.release(outgoing.frame);
+        outgoing.frame = nullptr;
+    }
+
+    CRGB *leds;
+    FramePool<2, NumLeds> pool; // the current segment and the one it is taking over from
+    Segment current;            // newest FROM cues
+    Segment outgoing;           // the ones before, while the transition lasts
+    uint16_t segment = 0;       // CuePlayer::segment() of current
+    CueTransition transition = TRANSITION_CUT;
+    uint32_t transitionStart = 0; // song position, ms
+    uint32_t transitionEnd = 0;
+};
+
+#endif // CROSSFADER_H
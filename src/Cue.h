@@ -0,0 +1,135 @@
+/*
+ * Cue tables: a show is a list of cues sorted by time, built at compile time.
+ *
+ * There are two kinds of cues:
+ *
+ * * CUE_FROM means starting FROM this time AND RUNNING IT EVERY FRAME
+ *   until the next FROM time comes. FROM cues with the same time all run.
+ *
+ * * CUE_AT means do this ONE TIME ONLY AT the designated time.
+ *
+ * What a cue does is its action (one of a fixed set of patterns and effects, see runCue()
+ * in main.cpp) with up to four arguments: a bpm, a brightness, CRGB colour codes...
+ * CuePlayer walks the table with a cursor, so a frame only looks at the cues it passed.
+ * The same cues can come from a .show file on the sd card instead (ShowFileFormat.h).
+ * Cues can also be placed at bars and beats through a tempo map (TempoMap.h).
+ *
+ *   constexpr Cue myShow[] = {
+ *     AT_CUE(0, 0, 00.001, CUE_BRIGHTNESS, BRIGHTNESS),
+ *     FROM_CUE(0, 0, 01.500, CUE_BPM, 120),
+ *     FROM_CUE(0, 0, 23.180, CUE_QUARTERS, CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black),
+ *     FROM_CUE_BLEND(0, 0, 25.512, TRANSITION_FADE, 50, CUE_PULSING), // half a second crossfade
+ *   };
+ *   static_assert(cuesSorted(myShow), "myShow: cues out of order");
+ */
+
+#ifndef CUE_H
+#define CUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TC(HOURS, MINUTES, SECONDS)                         \
+  ((uint32_t)(((uint32_t)((HOURS) * (uint32_t)(3600000))) + \
+              ((uint32_t)((MINUTES) * (uint32_t)(60000))) + \
+              ((uint32_t)((SECONDS) * (uint32_t)(1000)))))
+
+#define AT_CUE(HOURS, MINUTES, SECONDS, ACTION, ...) \
+  Cue { TC(HOURS, MINUTES, SECONDS), CUE_AT, ACTION, TRANSITION_CUT, 0, { __VA_ARGS__ } }
+#define FROM_CUE(HOURS, MINUTES, SECONDS, ACTION, ...) \
+  Cue { TC(HOURS, MINUTES, SECONDS), CUE_FROM, ACTION, TRANSITION_CUT, 0, { __VA_ARGS__ } }
+// a FROM cue that blends in over the previous one instead of cutting, see CueTransition
+#define FROM_CUE_BLEND(HOURS, MINUTES, SECONDS, TRANSITION, LENGTH, ACTION, ...) \
+  Cue { TC(HOURS, MINUTES, SECONDS), CUE_FROM, ACTION, TRANSITION, LENGTH, { __VA_ARGS__ } }
+
+enum CueKind : uint8_t
+{
+    CUE_AT,
+    CUE_FROM,
+};
+
+enum CueAction : uint8_t
+{
+    CUE_BRIGHTNESS,      // FastLED.setBrightness(brightness)
+    CUE_HUE,             // gHue = hue
+    CUE_FILL,            // fill_solid(color)
+    CUE_FADE,            // fadeToBlackBy(amount)
+    CUE_QUARTERS,        // quarters(color1, color2, color3, color4)
+    CUE_BPM,             // bpm(bpm)
+    CUE_PULSING,         // pulsing()
+    CUE_FLASH_PULSING,   // flashPulsing()
+    CUE_FILL_GRADUAL,    // fillGradual(bpm)
+    CUE_WIGGLE_LINES,    // wiggleLines(bpm)
+    CUE_APPLAUSE,        // applause(width)
+    CUE_JUGGLE,          // juggle()
+    CUE_RAINBOW_GLITTER, // rainbowWithGlitter()
+    CUE_CONFETTI,        // confetti()
+    CUE_FADE_TO_BLACK,   // fadeToBlack()
+};
+
+// how a FROM cue takes over from the one before it (Crossfader.h). AT cues don't use it
+enum CueTransition : uint8_t
+{
+    TRANSITION_CUT,  // hard cut, the new FROM replaces the old one in the same frame
+    TRANSITION_FADE, // crossfade over transitionLength x 10 ms
+    TRANSITION_BEAT, // crossfade that ends on a beat, transitionLength beats long
+    TRANSITION_WIPE, // the new FROM wipes over the old one along the strip in transitionLength x 10 ms
+};
+
+struct Cue
+{
+    uint32_t time;   // ms into the song, TC()
+    CueKind kind;
+    CueAction action;
+    CueTransition transition;
+    uint8_t transitionLength; // 10 ms steps, or beats for TRANSITION_BEAT
+    uint32_t args[4]; // action arguments, colours are 0xRRGGBB like CRGB::HTMLColorCode
+};
+
+// where CuePlayer gets its cues from, one at a time in time order:
+// a table compiled into the firmware (CueTable) or a show file on the sd card (ShowFile.h)
+class CueSource
+{
+public:
+    virtual bool next(Cue &cue) = 0; // false after the last cue
+    virtual void rewind() = 0;       // back to the first cue
+};
+
+class CueTable : public CueSource
+{
+public:
+    CueTable(const Cue *cues = nullptr, uint16_t count = 0) : cues(cues), count(count) {}
+    bool next(Cue &cue) override
+    {
+        if (index >= count)
+        {
+            return false;
+        }
+        cue = cues[index++];
+        return true;
+    }
+    void rewind() override { index = 0; }
+
+private:
+    const Cue *cues;
+    uint16_t count;
+    uint16_t index = 0;
+};
+
+// one song and its cue table
+struct Show
+{
+    const char *filename; // wav on the sd card
+    const Cue *cues;
+    uint16_t count;
+};
+#define SHOW(FILENAME, CUES) \
+  Show { FILENAME, CUES, sizeof(CUES) / sizeof(CUES[0]) }
+
+template <size_t N>
+constexpr bool cuesSorted(const Cue (&cues)[N], size_t i = 1)
+{
+    return i >= N || (cues[i - 1].time <= cues[i].time && cuesSorted(cues, i + 1));
+}
+
+#endif // CUE_H
@@ -0,0 +1,46 @@
+#include "CuePlayer.h"
+
+void CuePlayer::start(CueSource &source)
+{
+    this->source = &source;
+    source.rewind();
+    havePending = source.next(pending);
+    passed = 0;
+    fromCount = 0;
+    segments = 0;
+}
+
+void CuePlayer::advance(uint32_t positionMillis, CueRunner runAt)
+{
+    while (havePending && pending.time <= positionMillis)
+    {
+        if (pending.kind == CUE_AT)
+        {
+            runAt(pending);
+        }
+        else if (fromCount && from[0].time == pending.time)
+        {
+            // one more FROM at the same time
+            if (fromCount < MAX_FROM_CUES)
+            {
+                from[fromCount++] = pending;
+            }
+        }
+        else
+        {
+            from[0] = pending;
+            fromCount = 1;
+            segments++;
+        }
+        passed++;
+        havePending = source->next(pending);
+    }
+}
+
+void CuePlayer::runFrom(CueRunner run)
+{
+    for (int i = 0; i < fromCount; i++)
+    {
+        run(from[i]);
+    }
+}
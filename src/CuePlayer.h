@@ -0,0 +1,56 @@
+/*
+ * Plays a cue table (Cue.h) against the song position.
+ *
+ * A cursor points at the first cue the song hasn't reached. Every frame update() moves it
+ * past the cues that came due, runs the AT cues among them once and keeps a copy of the last
+ * FROM cues, which then run every frame until the next FROM. Because the song position only
+ * goes forward, each cue is looked at once per song and a frame costs the same however
+ * long the show is. Cues are read one at a time from a CueSource, so a show streamed from
+ * the sd card needs no more RAM than one compiled in.
+ */
+
+#ifndef CUEPLAYER_H
+#define CUEPLAYER_H
+
+#include "Cue.h"
+
+class CuePlayer
+{
+public:
+    typedef void (*CueRunner)(const Cue &cue);
+
+    void start(CueSource &source); // from the beginning of the song
+
+    // once per frame with the song position in ms. calls run for the AT cues reached since the last
+    // frame, in table order, then for the current FROM cues
+    void update(uint32_t positionMillis, CueRunner run)
+    {
+        advance(positionMillis, run);
+        runFrom(run);
+    }
+
+    // update() in two steps, for Crossfader which runs the FROM cues into their own frames
+    void advance(uint32_t positionMillis, CueRunner runAt); // moves the cursor and runs the AT cues reached
+    void runFrom(CueRunner run);                            // runs the current FROM cues
+
+    uint16_t cursor() const { return passed; } // number of cues reached so far
+
+    // the current FROM cues, they change when segment() does
+    const Cue *fromCues() const { return from; }
+    int fromCueCount() const { return fromCount; }
+    uint16_t segment() const { return segments; } // counts up every time new FROM cues take over
+
+    static const int MAX_FROM_CUES = 4; // FROM cues with the same time that all run, more are ignored
+
+private:
+    CueSource *source = nullptr;
+    Cue pending;              // next cue, not reached yet
+    bool havePending = false;
+    uint16_t passed = 0;
+
+    Cue from[MAX_FROM_CUES]; // current FROM cues
+    int fromCount = 0;
+    uint16_t segments = 0;
+};
+
+#endif // CUEPLAYER_H
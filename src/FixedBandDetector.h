@@ -0,0 +1,132 @@
+/*
+ * Fixed point version of BandDetector, selected with -D BEAT_DETECTOR_FIXED_POINT.
+ *
+ * Works on the raw uint16_t magnitudes of AudioAnalyzeFFT256::output[] summed over the
+ * band (read() divides the same sum by 16384 to get a float), so nothing gets converted
+ * to float per frame. Everything is kept multiplied by the window length N:
+ * the running total already is N x the average, the max and the current value are
+ * multiplied by N before comparing, and the threshold factor is Q15. That way there is
+ * no division anywhere in update(), only integer adds, compares and one 32x32->64 multiply.
+ *
+ * The average smoothing of the float version (average moves at most 0.0001 per frame)
+ * becomes a step of 0.0001 * 16384 * N on the N-scaled total.
+ */
+
+#ifndef FIXEDBANDDETECTOR_H
+#define FIXEDBANDDETECTOR_H
+
+#include <Audio.h>
+#include "BandConfig.h"
+#include "TelemetryFormat.h"
+
+template <int MaxReadings>
+class FixedBandDetector
+{
+public:
+    FixedBandDetector(const BandConfig &config)
+        : thresholdFactor((int32_t)(config.thresholdFactor * 32768)), retriggerTime(config.retriggerTime),
+          numReadings(config.window), smoothingStep((int32_t)(0.0001 * 16384 * config.window + 0.5))
+    {
+        if (smoothingStep < 1)
+        {
+            smoothingStep = 1;
+        }
+    }
+
+    // feed the band's raw magnitude sum for this fft frame. returns the magnitude in read() units if it is a beat, 0 otherwise
+    float update(uint32_t value)
+    {
+        audioValue = value;
+
+        // running total, N x average
+        total = total - readings[readIndex];
+        readings[readIndex] = audioValue;
+        total = total + audioValue;
+        if (++readIndex >= numReadings)
+        {
+            readIndex = 0;
+        }
+
+        // rolling max, same monotonic deque as BandDetector
+        if (dequeSize && frame - dequeFrame[dequeHead] >= (uint32_t)numReadings)
+        {
+            dequeHead = (dequeHead + 1) % MaxReadings;
+            dequeSize--;
+        }
+        while (dequeSize && dequeValue[(dequeHead + dequeSize - 1) % MaxReadings] <= audioValue)
+        {
+            dequeSize--;
+        }
+        int tail = (dequeHead + dequeSize) % MaxReadings;
+        dequeFrame[tail] = frame;
+        dequeValue[tail] = audioValue;
+        dequeSize++;
+        frame++;
+        maxValue = dequeValue[dequeHead];
+
+        // rate limited average, kept as N x average
+        int32_t target = (int32_t)total;
+        if (averageN - target > smoothingStep)
+        {
+            averageN -= smoothingStep;
+        }
+        else if (target - averageN > smoothingStep)
+        {
+            averageN += smoothingStep;
+        }
+        else
+        {
+            averageN = target;
+        }
+
+        int32_t maxN = (int32_t)(maxValue * numReadings);
+        thresholdN = (int32_t)(((int64_t)(maxN - averageN) * thresholdFactor) >> 15) + averageN;
+
+        int32_t valueN = (int32_t)(audioValue * numReadings);
+        if (valueN > thresholdN && valueN > 2 * averageN && retrigger > retriggerTime)
+        {
+            retrigger = 0;
+            return audioValue * (1.0f / 16384.0f);
+        }
+        return 0;
+    }
+
+    float level() const { return audioValue * (1.0f / 16384.0f); } // current magnitude in read() units
+
+    // fills in the values of the last update for the telemetry ring (Telemetry.h), in read() units like BandDetector
+    void telemetry(TelemetryRecord &record)
+    {
+        float scale = 1.0f / 16384.0f / numReadings;
+        record.average = averageN * scale;
+        record.maxValue = maxValue * (1.0f / 16384.0f);
+        record.threshold = thresholdN * scale;
+        record.value = audioValue * (1.0f / 16384.0f);
+        record.flags = retrigger > retriggerTime ? TELEMETRY_READY : 0;
+    }
+
+    int32_t thresholdFactor; // Q15, position of the beat threshold between average and max
+    uint32_t retriggerTime;  // time that a new beat detected will be ignored
+
+    // values from the last update
+    uint32_t audioValue = 0;
+    uint32_t maxValue = 0;
+    int32_t averageN = 0;   // N x average
+    int32_t thresholdN = 0; // N x threshold
+
+private:
+    int numReadings;
+    int32_t smoothingStep;
+    uint32_t readings[MaxReadings] = {};
+    int readIndex = 0;
+    uint32_t total = 0;
+
+    uint32_t frame = 0;
+    uint32_t dequeFrame[MaxReadings] = {};
+    uint32_t dequeValue[MaxReadings] = {};
+    int dequeHead = 0;
+    int dequeSize = 0;
+
+    elapsedMillis retrigger = 0;
+};
+
+#endif // FIXEDBANDDETECTOR_H
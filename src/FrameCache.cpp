@@ -0,0 +1,216 @@
+#include "FrameCache.h"
+#include "Sidecar.h"
+
+bool FrameCache::open(const char *wavFilename, uint32_t showId)
+{
+    close();
+
+    char name[64];
+    sidecarName(wavFilename, ".cache", name, sizeof(name));
+    if (!openSidecar(file, name))
+    {
+        return false;
+    }
+
+    FrameCacheHeader header;
+    int bytes = sidecarRead(file, &header, sizeof(header));
+    const char *problem = nullptr;
+    if (bytes != sizeof(header) || memcmp(header.magic, FRAMECACHE_MAGIC, 4) ||
+        header.version != FRAMECACHE_VERSION || !header.framePeriodMicros)
+    {
+        problem = " is not a frame cache";
+    }
+    else if (header.ledCount != NUM_LEDS)
+    {
+        problem = " is for another number of leds";
+    }
+    else if (header.showId != showId)
+    {
+        problem = " is for other cues, render it again";
+    }
+    if (problem)
+    {
+        Serial.print(name);
+        Serial.println(problem);
+        sidecarClose(file);
+        return false;
+    }
+
+    framePeriod = header.framePeriodMicros;
+    spanCount = header.spanCount;
+    opened = true;
+    seek(0);
+    return true;
+}
+
+void FrameCache::close()
+{
+    if (opened)
+    {
+        sidecarClose(file);
+    }
+    opened = false;
+    haveSpan = false;
+}
+
+void FrameCache::fail(const char *what)
+{
+    Serial.print("Frame cache ");
+    Serial.print(what);
+    Serial.println(", drawing the show without it");
+    close();
+}
+
+bool FrameCache::read(void *data, uint32_t size)
+{
+    uint8_t *bytes = (uint8_t *)data;
+    while (size)
+    {
+        if (bufferIndex >= buffered)
+        {
+            buffered = sidecarRead(file, buffer, BUFFER_SIZE);
+            bufferIndex = 0;
+            if (buffered <= 0)
+            {
+                buffered = 0;
+                return false;
+            }
+        }
+        uint32_t available = buffered - bufferIndex;
+        uint32_t count = available < size ? available : size;
+        memcpy(bytes, buffer + bufferIndex, count);
+        bufferIndex += count;
+        bytes += count;
+        size -= count;
+    }
+    return true;
+}
+
+void FrameCache::skip(uint32_t size)
+{
+    uint32_t inBuffer = buffered - bufferIndex;
+    if (size <= inBuffer)
+    {
+        bufferIndex += size;
+        return;
+    }
+    sidecarSeek(file, file.position() + size - inBuffer);
+    buffered = 0;
+    bufferIndex = 0;
+}
+
+bool FrameCache::nextSpan()
+{
+    haveSpan = spansLeft && read(&span, sizeof(span));
+    if (haveSpan)
+    {
+        spansLeft--;
+        decoded = 0;
+        spanBytes = span.dataSize;
+    }
+    return haveSpan;
+}
+
+void FrameCache::seek(uint32_t positionMillis)
+{
+    if (!opened)
+    {
+        return;
+    }
+    sidecarSeek(file, sizeof(FrameCacheHeader));
+    buffered = 0;
+    bufferIndex = 0;
+    spansLeft = spanCount;
+
+    // spans that start before the position can't be played any more
+    uint32_t index = ((uint64_t)positionMillis * 1000 + framePeriod - 1) / framePeriod;
+    while (nextSpan() && span.firstFrame < index)
+    {
+        skip(span.dataSize);
+    }
+}
+
+bool FrameCache::decodeFrame()
+{
+    uint32_t used = 0;
+    for (int led = 0; led < NUM_LEDS;)
+    {
+        uint8_t run;
+        if (!read(&run, 1))
+        {
+            return false;
+        }
+        int length = (run & ~FRAMECACHE_KIND_MASK) + 1;
+        used++;
+        if (led + length > NUM_LEDS)
+        {
+            return false;
+        }
+        switch (run & FRAMECACHE_KIND_MASK)
+        {
+        case FRAMECACHE_KEEP:
+            if (!decoded)
+            {
+                return false; // nothing to keep in the first frame of a span
+            }
+            break;
+        case FRAMECACHE_FILL:
+        {
+            CRGB color;
+            if (!read(color.raw, 3))
+            {
+                return false;
+            }
+            fill_solid(frame + led, length, color);
+            used += 3;
+            break;
+        }
+        case FRAMECACHE_COPY:
+            if (!read(frame + led, length * 3))
+            {
+                return false;
+            }
+            used += length * 3;
+            break;
+        default:
+            return false;
+        }
+        led += length;
+    }
+    if (used > spanBytes)
+    {
+        return false;
+    }
+    spanBytes -= used;
+    decoded++;
+    return true;
+}
+
+const CRGB *FrameCache::frameAt(uint32_t positionMillis)
+{
+    if (!opened)
+    {
+        return nullptr;
+    }
+    uint32_t index = ((uint64_t)positionMillis * 1000 + framePeriod - 1) / framePeriod;
+    while (haveSpan && index >= span.firstFrame + span.frameCount)
+    {
+        skip(spanBytes);
+        nextSpan();
+    }
+    if (!haveSpan || index < span.firstFrame)
+    {
+        return nullptr;
+    }
+
+    // frames that were dropped still have to be decoded, the next ones build on them
+    while (decoded <= index - span.firstFrame)
+    {
+        if (!decodeFrame())
+        {
+            fail("is broken");
+            return nullptr;
+        }
+    }
+    return frame;
+}
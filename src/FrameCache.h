@@ -0,0 +1,63 @@
+/*
+ * Plays back a song's pre-rendered frames (.cache next to the wav, FrameCacheFormat.h).
+ *
+ * For the frames that are in the cache renderFrame() takes them from here instead of
+ * running the patterns: no ColorFromPalette for every led, mostly a few runs of bytes.
+ * The file is read sequentially through a small buffer like the .show and .beats files,
+ * spans that the song has passed are skipped over with a seek.
+ *
+ * A span can only be played from its first frame. After a seek into the middle of one
+ * the show is drawn the usual way until the next span starts.
+ */
+
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <FastLED.h>
+#include <SD.h>
+#include "FrameCacheFormat.h"
+#include "LedLayout.h"
+
+class FrameCache
+{
+public:
+    // opens the cache of wavFilename (song.wav -> song.cache), false if there is none or it
+    // was rendered from other cues than the ones with showId (frameCacheShowId())
+    bool open(const char *wavFilename, uint32_t showId);
+    void close();
+    bool isOpen() { return opened; }
+
+    // at song start and after a seek: playback picks up at the first span from positionMillis on
+    void seek(uint32_t positionMillis);
+
+    // the frame at song position positionMillis (on the frame grid), nullptr if it isn't in the
+    // cache and has to be drawn. for renderFrame()
+    const CRGB *frameAt(uint32_t positionMillis);
+
+private:
+    bool nextSpan();     // reads the next span header, false after the last
+    bool decodeFrame();  // the next frame of the span into frame
+    bool read(void *data, uint32_t size);
+    void skip(uint32_t size);
+    void fail(const char *what);
+
+    File file;
+    bool opened = false;
+    uint32_t framePeriod = 0;
+    uint32_t spanCount = 0;
+    uint32_t spansLeft = 0; // headers not read yet
+
+    FrameCacheSpan span;
+    bool haveSpan = false;
+    uint32_t decoded = 0;   // frames of span in frame so far
+    uint32_t spanBytes = 0; // of span not read yet
+
+    CRGB frame[NUM_LEDS]; // last decoded frame, the KEEP runs of the next one refer to it
+
+    static const int BUFFER_SIZE = 512;
+    uint8_t buffer[BUFFER_SIZE];
+    int buffered = 0;
+    int bufferIndex = 0;
+};
+
+#endif // FRAMECACHE_H
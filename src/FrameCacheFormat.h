@@ -0,0 +1,76 @@
+/*
+ * .cache file format: pre-rendered frames of a show, next to its song, song.wav -> song.cache.
+ *
+ * Written by the host renderer (src/host/render.cpp -C) and played back by FrameCache
+ * instead of running the patterns. Only the frames that depend on nothing but the song
+ * position are in it, see cacheableFrame() in Shows.h. They come in spans, runs of such
+ * frames one after the other on the frame grid:
+ *
+ *   FrameCacheHeader
+ *   spanCount x (FrameCacheSpan, frameCount encoded frames)
+ *
+ * An encoded frame is a list of runs along the strip, each a byte with the kind of run in
+ * the top two bits and its length - 1 (1..64 leds) in the low six:
+ *
+ *   FRAMECACHE_KEEP  the leds are what they were in the frame before
+ *   FRAMECACHE_FILL  the leds are all one colour, r g b follow
+ *   FRAMECACHE_COPY  length x r g b follow
+ *
+ * The first frame of a span has no KEEP runs, so playback can start at any span.
+ * Little endian like the other formats.
+ */
+
+#ifndef FRAMECACHEFORMAT_H
+#define FRAMECACHEFORMAT_H
+
+#include <stdint.h>
+#include "Cue.h"
+
+#define FRAMECACHE_MAGIC "LEDC"
+#define FRAMECACHE_VERSION 2 // 1 had bpm() and wiggleLines() frames in it
+
+#define FRAMECACHE_KEEP 0x00
+#define FRAMECACHE_FILL 0x40
+#define FRAMECACHE_COPY 0x80
+#define FRAMECACHE_KIND_MASK 0xC0
+#define FRAMECACHE_MAX_RUN 64
+
+struct FrameCacheHeader
+{
+    char magic[4];              // FRAMECACHE_MAGIC
+    uint16_t version;           // FRAMECACHE_VERSION
+    uint16_t ledCount;
+    uint32_t framePeriodMicros; // the frame grid the show was rendered on
+    uint32_t showId;            // frameCacheShowId() of the cues it was rendered from
+    uint32_t spanCount;
+};
+
+struct FrameCacheSpan
+{
+    uint32_t firstFrame; // on the frame grid, frame n is at n x framePeriodMicros
+    uint32_t frameCount;
+    uint32_t dataSize;   // bytes of encoded frames after this
+};
+
+static_assert(sizeof(FrameCacheHeader) == 20, "FrameCacheHeader must be packed");
+static_assert(sizeof(FrameCacheSpan) == 12, "FrameCacheSpan must be packed");
+
+// checksum of a show's cues, so a cache rendered before the show was changed isn't played
+inline uint32_t frameCacheShowId(CueSource &cues)
+{
+    uint32_t hash = 2166136261u; // FNV-1a
+    Cue cue;
+    cues.rewind();
+    while (cues.next(cue))
+    {
+        const uint8_t *bytes = (const uint8_t *)&cue;
+        for (unsigned i = 0; i < sizeof(Cue); i++)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+    }
+    cues.rewind();
+    return hash;
+}
+
+#endif // FRAMECACHEFORMAT_H
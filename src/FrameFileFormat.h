@@ -0,0 +1,39 @@
+/*
+ * .frames file format: every frame of a rendered show, written by the host renderer
+ * (src/host/render.cpp) and read by tools/frames.py.
+ *
+ *   FrameFileHeader
+ *   frameCount x (FrameHeader, ledCount x 3 bytes r g b)
+ *
+ * The colours are leds[] as the patterns left them, before FastLED's brightness,
+ * which is in the frame header. Little endian like the other formats.
+ */
+
+#ifndef FRAMEFILEFORMAT_H
+#define FRAMEFILEFORMAT_H
+
+#include <stdint.h>
+
+#define FRAMEFILE_MAGIC "LEDF"
+#define FRAMEFILE_VERSION 1
+
+struct FrameFileHeader
+{
+    char magic[4];              // FRAMEFILE_MAGIC
+    uint16_t version;           // FRAMEFILE_VERSION
+    uint16_t ledCount;
+    uint32_t framePeriodMicros; // the frame grid the show was rendered on
+    uint32_t frameCount;
+};
+
+struct FrameHeader
+{
+    uint32_t time;      // song position, ms
+    uint8_t brightness; // FastLED.setBrightness()
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(FrameFileHeader) == 16, "FrameFileHeader must be packed");
+static_assert(sizeof(FrameHeader) == 8, "FrameHeader must be packed");
+
+#endif // FRAMEFILEFORMAT_H
@@ -0,0 +1,49 @@
+/*
+ * A fixed number of led frames allocated once, for code that needs a frame for a while
+ * (Crossfader keeps one per show segment). acquire() and release() only flip bits, so
+ * nothing touches the heap while the show runs.
+ */
+
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <FastLED.h>
+
+template <int Frames, int NumLeds>
+class FramePool
+{
+    static_assert(Frames <= 32, "FramePool keeps its free frames in a 32 bit mask");
+
+public:
+    CRGB *acquire() // nullptr if all frames are in use
+    {
+        for (int i = 0; i < Frames; i++)
+        {
+            if (!(used & (1u << i)))
+            {
+                used |= 1u << i;
+                return frames[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void release(CRGB *frame)
+    {
+        for (int i = 0; i < Frames; i++)
+        {
+            if (frames[i] == frame)
+            {
+                used &= ~(1u << i);
+            }
+        }
+    }
+
+    void releaseAll() { used = 0; }
+
+private:
+    CRGB frames[Frames][NumLeds];
+    uint32_t used = 0; // bit per frame
+};
+
+#endif // FRAMEPOOL_H
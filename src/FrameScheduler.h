@@ -0,0 +1,108 @@
+/*
+ * Decides when the next frame gets drawn and for which moment of the song.
+ *
+ * Frames sit on a fixed grid of the audio clock, one every framePeriod µs of song time.
+ * A frame is drawn for the grid point it will be visible at: it is started when the
+ * audio position plus the time it takes to render it and get it onto the strip reaches
+ * that point. When the loop falls behind, the grid points already passed are skipped
+ * rather than drawn late, so the lights never drift from the music, they just get
+ * choppier. Both are counted:
+ *
+ *   framesDropped  grid points that got no frame
+ *   framesLate     frames that reached the strip more than half a period after their time
+ *
+ * All times are audio time in µs (WavPlayer::positionMicros()), which also runs on when
+ * the loop is slow. How long a frame takes from show() to the strip changes with how busy
+ * the wire still is, endFrame() is told every frame.
+ */
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <stdint.h>
+
+class FrameScheduler
+{
+public:
+    // outputMicros: first guess of the time from show() returning until the strip shows the frame
+    FrameScheduler(uint32_t framePeriodMicros, uint32_t outputMicros) : framePeriod(framePeriodMicros), outputEstimate(outputMicros) {}
+
+    // at song start and after a seek, frames count from audioMicros on
+    void reset(uint32_t audioMicros)
+    {
+        nextFrame = audioMicros / framePeriod;
+        startMicros = audioMicros;
+        lastFrameMicros = audioMicros;
+        framesDrawn = 0;
+        framesDropped = 0;
+        framesLate = 0;
+    }
+
+    // true when the next frame has to be started to be visible on time
+    bool due(uint32_t audioMicros) const { return audioMicros + latency() >= frameMicros(nextFrame); }
+
+    // starts a frame, returns the song time in µs it is to be drawn for
+    uint32_t beginFrame(uint32_t audioMicros)
+    {
+        uint32_t frame = (audioMicros + latency()) / framePeriod; // the last grid point it can still make
+        if (frame > nextFrame)
+        {
+            framesDropped += frame - nextFrame;
+        }
+        else
+        {
+            frame = nextFrame;
+        }
+        nextFrame = frame + 1;
+        frameStart = audioMicros;
+        return frameMicros(frame);
+    }
+
+    // after show(), with the audio time then and how long until the strip shows the frame
+    void endFrame(uint32_t audioMicros, uint32_t outputMicros)
+    {
+        renderEstimate = estimate(renderEstimate, audioMicros - frameStart);
+        outputEstimate = estimate(outputEstimate, outputMicros);
+
+        uint32_t visible = audioMicros + outputMicros;
+        if ((int32_t)(visible - frameMicros(nextFrame - 1)) > (int32_t)(framePeriod / 2))
+        {
+            framesLate++;
+        }
+        framesDrawn++;
+        lastFrameMicros = audioMicros;
+    }
+
+    uint32_t frameMicros(uint32_t frame) const { return frame * framePeriod; }
+    uint32_t period() const { return framePeriod; }
+
+    // frames drawn per second of song since reset()
+    float framesPerSecond() const
+    {
+        uint32_t played = lastFrameMicros - startMicros;
+        return played ? framesDrawn * 1e6f / played : 0;
+    }
+
+    uint32_t framesDrawn = 0;
+    uint32_t framesDropped = 0;
+    uint32_t framesLate = 0;
+
+private:
+    uint32_t latency() const { return renderEstimate + outputEstimate; }
+
+    // goes up at once and down slowly, so one quick frame doesn't make the next one late
+    static uint32_t estimate(uint32_t estimate, uint32_t time)
+    {
+        return time > estimate ? time : estimate - (estimate - time) / 16;
+    }
+
+    uint32_t framePeriod;
+    uint32_t outputEstimate;
+    uint32_t renderEstimate = 0; // from beginFrame() to endFrame()
+    uint32_t nextFrame = 0;      // grid index
+    uint32_t frameStart = 0;
+    uint32_t startMicros = 0;     // reset()
+    uint32_t lastFrameMicros = 0; // endFrame()
+};
+
+#endif // FRAMESCHEDULER_H
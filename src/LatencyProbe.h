@@ -0,0 +1,109 @@
+/*
+ * How long the buzzer takes, measured on every press that starts a song:
+ *
+ *   audio  press to the song starting in WavPlayer. the speakers get it LOOKAHEAD_MS
+ *          and one audio block later
+ *   light  press to the first frame with a lit led being on the strip
+ *
+ * The last SAMPLES presses are kept, report() prints min, median and p99 of them. All
+ * times come from micros(), the press from the pin interrupt (ButtonTrigger).
+ */
+
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include <stdint.h>
+
+class LatencyProbe
+{
+public:
+    static const int SAMPLES = 64;
+
+    void pressed(uint32_t pressedMicros)
+    {
+        pressMicros = pressedMicros;
+        state = WAITING_FOR_AUDIO;
+    }
+
+    void audioStarted(uint32_t startMicros)
+    {
+        if (state == WAITING_FOR_AUDIO)
+        {
+            audioMicros = startMicros - pressMicros;
+            state = WAITING_FOR_LIGHT;
+        }
+    }
+
+    bool waitingForLight() const { return state == WAITING_FOR_LIGHT; }
+
+    // the first lit frame is visible at visibleMicros, the press is measured
+    void lit(uint32_t visibleMicros)
+    {
+        if (state != WAITING_FOR_LIGHT)
+        {
+            return;
+        }
+        audio[next] = audioMicros;
+        light[next] = visibleMicros - pressMicros;
+        next = (next + 1) % SAMPLES;
+        if (count < SAMPLES)
+        {
+            count++;
+        }
+        state = IDLE;
+    }
+
+    uint32_t lastAudio() const { return audio[(next + SAMPLES - 1) % SAMPLES]; }
+    uint32_t lastLight() const { return light[(next + SAMPLES - 1) % SAMPLES]; }
+
+    // Port is Serial on the teensy, anything with printf() works
+    template <class Port>
+    void report(Port &port) const
+    {
+        if (!count)
+        {
+            port.printf("No presses measured yet\n");
+            return;
+        }
+        port.printf("Latency of the last %d presses\n", count);
+        port.printf("  %-24s %7s %7s %7s\n", "us", "min", "median", "p99");
+        reportLine(port, "press to audio", audio);
+        reportLine(port, "press to light", light);
+    }
+
+private:
+    template <class Port>
+    void reportLine(Port &port, const char *name, const uint32_t *samples) const
+    {
+        uint32_t sorted[SAMPLES];
+        for (int i = 0; i < count; i++)
+        {
+            // insertion sort, it's 64 values at most and only on request
+            int j = i;
+            for (; j > 0 && sorted[j - 1] > samples[i]; j--)
+            {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = samples[i];
+        }
+        int p99 = (count * 99 + 99) / 100 - 1; // nearest rank
+        port.printf("  %-24s %7u %7u %7u\n", name, (unsigned)sorted[0], (unsigned)sorted[count / 2], (unsigned)sorted[p99]);
+    }
+
+    enum State : uint8_t
+    {
+        IDLE,
+        WAITING_FOR_AUDIO,
+        WAITING_FOR_LIGHT,
+    };
+
+    State state = IDLE;
+    uint32_t pressMicros = 0;
+    uint32_t audioMicros = 0; // of the press being measured
+    uint32_t audio[SAMPLES];
+    uint32_t light[SAMPLES];
+    int next = 0;
+    int count = 0;
+};
+
+#endif // LATENCYPROBE_H
@@ -0,0 +1,339 @@
+/*
+ * Where the leds are in the room, worked out at compile time from LED_SEGMENTS
+ * (LedLayout.h) into tables in flash. Patterns look things up instead of working out
+ * indexes, so they don't change with the layout:
+ *
+ *   ledSegment(WALL_2)    first led and count of a segment in leds[]
+ *   ledAlong(i)           the i-th led going round the room in the order of LED_SEGMENTS,
+ *                         whichever way each strip was wired
+ *   ledX(i), ledY(i)      where led i is, 0 to 255 across the room
+ *   ledAngle(i)           its direction from the middle of the room, in 256ths of a turn
+ *                         counterclockwise from +x like sin8()
+ *   ledsAtAngle(a)        all leds with ledAngle() a, as a range of ledsByAngle
+ *   ledMatrix(row, col)   the led at row, col of LED_MATRIX
+ *
+ *   for (uint16_t i = ledsAtAngle(a).first; i < ledsAtAngle(a).end; i++)
+ *     leds[ledsByAngle(i)] = CRGB::White;
+ *
+ * Each table is an object of its own, NUM_LEDS long: at 8 x 500 leds every byte per led
+ * is 4 KB of flash, and only the tables a pattern looks at are linked in.
+ *
+ * The teensy 4 reads flash like memory, PROGMEM only keeps the tables out of RAM.
+ */
+
+#ifndef LEDGEOMETRY_H
+#define LEDGEOMETRY_H
+
+#include <Arduino.h>
+#include "LedLayout.h"
+
+const int LED_SEGMENT_COUNT = sizeof(LED_SEGMENTS) / sizeof(LED_SEGMENTS[0]);
+
+struct LedSegment
+{
+    uint16_t first; // in leds[], also where it starts in ledAlong()
+    uint16_t count;
+};
+
+struct LedRange
+{
+    uint16_t first;
+    uint16_t end; // one past the last
+};
+
+// an array the make functions below can return
+template <typename T, int N>
+struct LedTable
+{
+    T entries[N];
+
+    constexpr T &operator[](int i) { return entries[i]; }
+    constexpr const T &operator[](int i) const { return entries[i]; }
+};
+
+constexpr bool ledSegmentsValid()
+{
+    int total = 0;
+    for (const LedSegmentSpec &spec : LED_SEGMENTS)
+    {
+        if (!spec.count)
+        {
+            return false;
+        }
+        total += spec.count;
+    }
+    return total == NUM_LEDS;
+}
+static_assert(ledSegmentsValid(), "LED_SEGMENTS: every segment needs leds, and all of them together NUM_LEDS");
+
+static_assert(LED_SEGMENT_COUNT == WALL_4 + 1, "LED_SEGMENTS: one segment for each LedSegmentName");
+
+constexpr LedTable<LedSegment, LED_SEGMENT_COUNT> makeLedSegments()
+{
+    LedTable<LedSegment, LED_SEGMENT_COUNT> segments{};
+    uint16_t first = 0;
+    for (int s = 0; s < LED_SEGMENT_COUNT; s++)
+    {
+        segments[s] = {first, LED_SEGMENTS[s].count};
+        first += LED_SEGMENTS[s].count;
+    }
+    return segments;
+}
+
+PROGMEM constexpr LedTable<LedSegment, LED_SEGMENT_COUNT> ledSegmentTable = makeLedSegments();
+
+// the segment led is in
+constexpr int segmentOf(int led, int s = 0)
+{
+    return led < ledSegmentTable[s].first + ledSegmentTable[s].count ? s : segmentOf(led, s + 1);
+}
+
+// how far led is along its segment from (x0, y0), 0 to count - 1
+constexpr int stepOf(int led)
+{
+    const LedSegmentSpec &spec = LED_SEGMENTS[segmentOf(led)];
+    int k = led - ledSegmentTable[segmentOf(led)].first;
+    return spec.reversed ? spec.count - 1 - k : k;
+}
+
+constexpr LedTable<uint16_t, NUM_LEDS> makeLedAlong()
+{
+    LedTable<uint16_t, NUM_LEDS> along{};
+    for (int led = 0; led < NUM_LEDS; led++)
+    {
+        along[ledSegmentTable[segmentOf(led)].first + stepOf(led)] = led;
+    }
+    return along;
+}
+
+PROGMEM constexpr LedTable<uint16_t, NUM_LEDS> ledAlongTable = makeLedAlong();
+
+// the segments follow each other through leds[], and going along each one visits every led
+// of it once, from the end it was wired from
+constexpr bool ledAlongValid()
+{
+    uint16_t first = 0;
+    for (int s = 0; s < LED_SEGMENT_COUNT; s++)
+    {
+        const LedSegment &segment = ledSegmentTable[s];
+        if (segment.first != first || segment.count != LED_SEGMENTS[s].count)
+        {
+            return false;
+        }
+        uint16_t end = first + segment.count;
+        if (ledAlongTable[first] != (LED_SEGMENTS[s].reversed ? end - 1 : first))
+        {
+            return false;
+        }
+        bool seen[NUM_LEDS] = {};
+        for (int i = first; i < end; i++)
+        {
+            uint16_t led = ledAlongTable[i];
+            if (led < first || led >= end || seen[led])
+            {
+                return false;
+            }
+            seen[led] = true;
+        }
+        first = end;
+    }
+    return true;
+}
+static_assert(ledAlongValid(), "ledAlongTable doesn't go through every segment once");
+
+// x of led in LED_SEGMENTS units, the middle of its stretch of the segment's line
+constexpr float roomX(int led)
+{
+    const LedSegmentSpec &spec = LED_SEGMENTS[segmentOf(led)];
+    return spec.x0 + (spec.x1 - spec.x0) * (stepOf(led) + 0.5f) / spec.count;
+}
+
+constexpr float roomY(int led)
+{
+    const LedSegmentSpec &spec = LED_SEGMENTS[segmentOf(led)];
+    return spec.y0 + (spec.y1 - spec.y0) * (stepOf(led) + 0.5f) / spec.count;
+}
+
+// the box round the ends of all the segments
+struct RoomBounds
+{
+    float minX, maxX, minY, maxY;
+};
+
+constexpr RoomBounds roomBounds()
+{
+    RoomBounds bounds{LED_SEGMENTS[0].x0, LED_SEGMENTS[0].x0, LED_SEGMENTS[0].y0, LED_SEGMENTS[0].y0};
+    for (const LedSegmentSpec &spec : LED_SEGMENTS)
+    {
+        bounds.minX = spec.x0 < bounds.minX ? spec.x0 : bounds.minX;
+        bounds.minX = spec.x1 < bounds.minX ? spec.x1 : bounds.minX;
+        bounds.maxX = spec.x0 > bounds.maxX ? spec.x0 : bounds.maxX;
+        bounds.maxX = spec.x1 > bounds.maxX ? spec.x1 : bounds.maxX;
+        bounds.minY = spec.y0 < bounds.minY ? spec.y0 : bounds.minY;
+        bounds.minY = spec.y1 < bounds.minY ? spec.y1 : bounds.minY;
+        bounds.maxY = spec.y0 > bounds.maxY ? spec.y0 : bounds.maxY;
+        bounds.maxY = spec.y1 > bounds.maxY ? spec.y1 : bounds.maxY;
+    }
+    return bounds;
+}
+
+constexpr uint8_t scaleTo8(float value, float low, float high)
+{
+    return high > low ? (uint8_t)((value - low) * 255 / (high - low) + 0.5f) : 128;
+}
+
+constexpr LedTable<uint8_t, NUM_LEDS> makeLedX()
+{
+    LedTable<uint8_t, NUM_LEDS> x{};
+    for (int led = 0; led < NUM_LEDS; led++)
+    {
+        x[led] = scaleTo8(roomX(led), roomBounds().minX, roomBounds().maxX);
+    }
+    return x;
+}
+
+constexpr LedTable<uint8_t, NUM_LEDS> makeLedY()
+{
+    LedTable<uint8_t, NUM_LEDS> y{};
+    for (int led = 0; led < NUM_LEDS; led++)
+    {
+        y[led] = scaleTo8(roomY(led), roomBounds().minY, roomBounds().maxY);
+    }
+    return y;
+}
+
+PROGMEM constexpr LedTable<uint8_t, NUM_LEDS> ledXTable = makeLedX();
+PROGMEM constexpr LedTable<uint8_t, NUM_LEDS> ledYTable = makeLedY();
+
+// atan2 in 256ths of a turn, to within one of them, which is all a led needs
+constexpr uint8_t angle8(float y, float x)
+{
+    float ax = x < 0 ? -x : x;
+    float ay = y < 0 ? -y : y;
+    if (ax == 0 && ay == 0)
+    {
+        return 0;
+    }
+    float z = ax > ay ? ay / ax : ax / ay;
+    float turns = z * (0.125f + 0.04345f * (1 - z)); // atan(z) ~ pi/4 z + 0.273 z (1 - z)
+    if (ay > ax)
+    {
+        turns = 0.25f - turns;
+    }
+    if (x < 0)
+    {
+        turns = 0.5f - turns;
+    }
+    if (y < 0)
+    {
+        turns = 1 - turns;
+    }
+    return (int)(turns * 256 + 0.5f) & 255;
+}
+
+constexpr LedTable<uint8_t, NUM_LEDS> makeLedAngle()
+{
+    LedTable<uint8_t, NUM_LEDS> angle{};
+    float middleX = (roomBounds().minX + roomBounds().maxX) / 2;
+    float middleY = (roomBounds().minY + roomBounds().maxY) / 2;
+    for (int led = 0; led < NUM_LEDS; led++)
+    {
+        angle[led] = angle8(roomY(led) - middleY, roomX(led) - middleX);
+    }
+    return angle;
+}
+
+PROGMEM constexpr LedTable<uint8_t, NUM_LEDS> ledAngleTable = makeLedAngle();
+
+// where each angle's leds are in ledsByAngleTable, a counting sort
+constexpr LedTable<LedRange, 256> makeLedsAtAngle()
+{
+    LedTable<LedRange, 256> ranges{};
+    for (int led = 0; led < NUM_LEDS; led++)
+    {
+        ranges[ledAngleTable[led]].end++;
+    }
+    uint16_t start = 0;
+    for (int a = 0; a < 256; a++)
+    {
+        uint16_t count = ranges[a].end;
+        ranges[a] = {start, (uint16_t)(start + count)};
+        start += count;
+    }
+    return ranges;
+}
+
+PROGMEM constexpr LedTable<LedRange, 256> ledsAtAngleTable = makeLedsAtAngle();
+
+// leds sorted by angle, in leds[] order within one
+constexpr LedTable<uint16_t, NUM_LEDS> makeLedsByAngle()
+{
+    LedTable<uint16_t, NUM_LEDS> byAngle{};
+    LedTable<uint16_t, 256> next{};
+    for (int a = 0; a < 256; a++)
+    {
+        next[a] = ledsAtAngleTable[a].first;
+    }
+    for (int led = 0; led < NUM_LEDS; led++)
+    {
+        byAngle[next[ledAngleTable[led]]++] = led;
+    }
+    return byAngle;
+}
+
+PROGMEM constexpr LedTable<uint16_t, NUM_LEDS> ledsByAngleTable = makeLedsByAngle();
+
+// every led once, under its own angle
+constexpr bool ledsByAngleValid()
+{
+    if (ledsAtAngleTable[0].first != 0 || ledsAtAngleTable[255].end != NUM_LEDS)
+    {
+        return false;
+    }
+    bool seen[NUM_LEDS] = {};
+    for (int a = 0; a < 256; a++)
+    {
+        const LedRange &range = ledsAtAngleTable[a];
+        if (range.end < range.first || (a > 0 && range.first != ledsAtAngleTable[a - 1].end))
+        {
+            return false;
+        }
+        for (int i = range.first; i < range.end; i++)
+        {
+            uint16_t led = ledsByAngleTable[i];
+            if (led >= NUM_LEDS || seen[led] || ledAngleTable[led] != a)
+            {
+                return false;
+            }
+            seen[led] = true;
+        }
+    }
+    return true;
+}
+static_assert(ledsByAngleValid(), "ledsByAngleTable doesn't hold every led once under its angle");
+
+static_assert(LED_MATRIX.columns && LED_MATRIX.rows && LED_MATRIX.first + LED_MATRIX.columns * LED_MATRIX.rows <= NUM_LEDS,
+              "LED_MATRIX: has to fit in leds[]");
+
+constexpr LedTable<uint16_t, LED_MATRIX.columns * LED_MATRIX.rows> makeLedMatrix()
+{
+    LedTable<uint16_t, LED_MATRIX.columns * LED_MATRIX.rows> matrix{};
+    for (int i = 0; i < LED_MATRIX.columns * LED_MATRIX.rows; i++)
+    {
+        matrix[i] = LED_MATRIX.first + i;
+    }
+    return matrix;
+}
+
+PROGMEM constexpr LedTable<uint16_t, LED_MATRIX.columns * LED_MATRIX.rows> ledMatrixTable = makeLedMatrix();
+
+inline const LedSegment &ledSegment(int segment) { return ledSegmentTable[segment]; }
+inline uint16_t ledAlong(int i) { return ledAlongTable[i]; }
+inline uint8_t ledX(int led) { return ledXTable[led]; }
+inline uint8_t ledY(int led) { return ledYTable[led]; }
+inline uint8_t ledAngle(int led) { return ledAngleTable[led]; }
+inline const LedRange &ledsAtAngle(uint8_t angle) { return ledsAtAngleTable[angle]; }
+inline uint16_t ledsByAngle(int i) { return ledsByAngleTable[i]; }
+inline uint16_t ledMatrix(int row, int column) { return ledMatrixTable[row * LED_MATRIX.columns + column]; }
+
+#endif // LEDGEOMETRY_H
@@ -0,0 +1,73 @@
+/*
+ * How the leds are wired: numPins strips of ledsPerStrip leds on the OctoWS2811 outputs,
+ * one after the other in leds[].
+ *
+ * Set at build time with -D LED_STRIPS=8 -D LEDS_PER_STRIP=500 (see [env:teensy40_room] in
+ * platformio.ini), without them it's the one strip of 120 in the bathroom. Everything takes
+ * its size from here: the buffers, the controller and the patterns, which place things
+ * relative to the length of leds[] (Patterns.cpp), so the same shows run on any of them.
+ *
+ * Where the leds are in the room is LED_SEGMENTS at the end: straight runs of leds, in the
+ * order they are wired, and LED_MATRIX for the one pattern drawn on a grid. For another room
+ * those are all that changes, the patterns find their way through the tables LedGeometry.h
+ * makes from them.
+ *
+ * A frame takes the strips 30 µs per led of one strip plus a 300 µs reset to show, all
+ * strips at once, so FRAMES_PER_SECOND can be at most about 1000000 / (30 * ledsPerStrip
+ * + 300): 65 at 500 leds a strip. [env:teensy40_room] runs 8 x 500 at 60. The fps a song
+ * actually got, with the rendering, is printed after it ends.
+ */
+
+#ifndef LEDLAYOUT_H
+#define LEDLAYOUT_H
+
+#include <stdint.h>
+
+#ifndef LED_STRIPS
+#define LED_STRIPS 1
+#endif
+#ifndef LEDS_PER_STRIP
+#define LEDS_PER_STRIP 120
+#endif
+
+const int numPins = LED_STRIPS;
+const int ledsPerStrip = LEDS_PER_STRIP;
+const int NUM_LEDS = numPins * ledsPerStrip;
+
+static_assert(numPins >= 1 && numPins <= 8, "LED_STRIPS: OctoWS2811 has 8 outputs");
+
+// count leds in a straight line from (x0, y0) to (x1, y1) in the room, any unit. reversed:
+// wired the other way round, the data comes in at (x1, y1)
+struct LedSegmentSpec
+{
+    uint16_t count;
+    float x0, y0, x1, y1;
+    bool reversed;
+};
+
+// The four walls of a room 3 by 2, counterclockwise, with the leds spread over them
+// like the 36, 24, 36 and 24 of the bathroom
+enum LedSegmentName : uint8_t
+{
+    WALL_1,
+    WALL_2,
+    WALL_3,
+    WALL_4,
+};
+constexpr LedSegmentSpec LED_SEGMENTS[] = {
+    {NUM_LEDS * 3 / 10, 0, 0, 3, 0, false},
+    {NUM_LEDS / 2 - NUM_LEDS * 3 / 10, 3, 0, 3, 2, false},
+    {NUM_LEDS * 8 / 10 - NUM_LEDS / 2, 3, 2, 0, 2, false},
+    {NUM_LEDS - NUM_LEDS * 8 / 10, 0, 2, 0, 0, false},
+};
+
+// spewFour()'s matrix: rows of columns leds from led first on, one row after the other and
+// every row wired the same way (Z-layout). The bathroom's is the first 32 leds, 8 by 4
+struct LedMatrixSpec
+{
+    uint16_t first;
+    uint8_t columns, rows;
+};
+constexpr LedMatrixSpec LED_MATRIX = {0, 8, 4};
+
+#endif // LEDLAYOUT_H
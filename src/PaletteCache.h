@@ -0,0 +1,63 @@
+/*
+ * ColorFromPalette() from a table. The patterns ask for a palette colour for every led
+ * every frame, each one blending two of the 16 palette entries and scaling the result by
+ * a brightness. Here the 256 blended colours are worked out once, when the palette
+ * changes, and a colour is a table read and a multiply per channel for the brightness.
+ *
+ * color() gives exactly what ColorFromPalette(palette, index, brightness) with LINEARBLEND
+ * does (FastLED 3.5, FASTLED_SCALE8_FIXED), so the shows look the same as before and the
+ * frame caches rendered with ColorFromPalette() stay right.
+ */
+
+#ifndef PALETTECACHE_H
+#define PALETTECACHE_H
+
+#include <FastLED.h>
+
+class PaletteCache
+{
+public:
+    explicit PaletteCache(const CRGBPalette16 &palette) { expand(palette); }
+
+    // switches to palette, the table is only made again if it is another one
+    void use(const CRGBPalette16 &palette)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            if (palette[i] != entries[i])
+            {
+                expand(palette);
+                return;
+            }
+        }
+    }
+
+    CRGB color(uint8_t index) const { return colors[index]; }
+
+    // ColorFromPalette() scales with brightness + 1 and leaves black black, that is
+    // channel * (brightness + 2) / 256 for every brightness but 0
+    CRGB color(uint8_t index, uint8_t brightness) const
+    {
+        const CRGB &color = colors[index];
+        uint16_t scale = brightness ? brightness + 2 : 0;
+        return CRGB((color.r * scale) >> 8, (color.g * scale) >> 8, (color.b * scale) >> 8);
+    }
+
+private:
+    void expand(const CRGBPalette16 &palette)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            entries[i] = palette[i];
+        }
+        for (int i = 0; i < 256; i++)
+        {
+            colors[i] = ColorFromPalette(palette, i, 255, LINEARBLEND);
+        }
+    }
+
+    CRGB entries[16]; // of the palette in colors
+    CRGB colors[256];
+};
+
+#endif // PALETTECACHE_H
@@ -0,0 +1,479 @@
+#include "Patterns.h"
+#include "LedGeometry.h"
+
+CRGB leds[NUM_LEDS];
+CRGBSet ledset(leds, NUM_LEDS);
+uint8_t gHue = 0;
+PaletteCache gPartyColors(PartyColors_p);
+
+PatternState gPatterns;
+
+void resetPatterns()
+{
+  gPatterns = PatternState();
+  gPatterns.applause.hue = random8(HUE_BLUE, HUE_PURPLE);
+  gPatterns.spew.hue = random8();
+  for (int j = 0; j < 4; j++)
+  {
+    gPatterns.spewFour.hue[j] = random8();
+  }
+}
+
+// a colour for each wall of LED_SEGMENTS
+void quarters(const CRGB &color1, const CRGB &color2, const CRGB &color3, const CRGB &color4)
+{
+  fill_solid(leds + ledSegment(WALL_1).first, ledSegment(WALL_1).count, color1);
+  fill_solid(leds + ledSegment(WALL_2).first, ledSegment(WALL_2).count, color2);
+  fill_solid(leds + ledSegment(WALL_3).first, ledSegment(WALL_3).count, color3);
+  fill_solid(leds + ledSegment(WALL_4).first, ledSegment(WALL_4).count, color4);
+}
+
+void rainbow()
+{
+  // FastLED's built-in rainbow generator
+  fill_rainbow(leds, NUM_LEDS, gHue, 7);
+}
+
+void rainbowWithGlitter()
+{
+  // built-in FastLED rainbow, plus some random sparkly glitter
+  rainbow();
+  addGlitter(80);
+}
+
+void addGlitter(fract8 chanceOfGlitter)
+{
+  if (random8() < chanceOfGlitter)
+  {
+    leds[random16(NUM_LEDS)] += CRGB::White;
+  }
+}
+
+void confetti()
+{
+  // random colored speckles that blink in and fade smoothly
+  fadeToBlackBy(leds, NUM_LEDS, 10);
+  int pos = random16(NUM_LEDS);
+  leds[pos] += CHSV(gHue + random8(64), 200, 255);
+}
+
+void flashPulsing()
+{
+  // white flash on every beat. once the beat clock is locked the flash decays with the
+  // phase of the beat, so it lines up with the music no matter when this frame is drawn
+  if (beatDetector.beatPhaseValid())
+  {
+    uint8_t level = 255 - beatDetector.beatPhase();
+    level = scale8(level, level);
+    fill_solid(leds, NUM_LEDS, CRGB(level, level, level));
+    return;
+  }
+  fadeToBlackBy(leds, NUM_LEDS, 8);
+  if (beatDetector.virtualBeat)
+  {
+    for (int i = 0; i < NUM_LEDS; i++)
+    {
+      leds[i] = CRGB::White;
+    }
+  }
+}
+
+void pulsing()
+{
+  if (beatDetector.beatPhaseValid())
+  {
+    // full colour on the beat, dimming over the beat
+    uint8_t level = 255 - beatDetector.beatPhase();
+    for (int i = 0; i < NUM_LEDS; i++)
+    {
+      leds[i] = gPartyColors.color(gHue + (i * 2), scale8(gHue + (i * 10), level));
+    }
+    return;
+  }
+  fadeToBlackBy(leds, NUM_LEDS, 1);
+  if (beatDetector.virtualBeat)
+  {
+    for (int i = 0; i < NUM_LEDS; i++)
+    {
+      leds[i] = gPartyColors.color(gHue + (i * 2), gHue + (i * 10));
+    }
+  }
+}
+
+// Tempo for the tempo-synced patterns. The shows pass the tempo they were choreographed at,
+// once the beat detector is confident about the music's tempo that is used instead,
+// moved by whole octaves so it stays closest to what the show asked for (a show at half
+// or double time keeps running at half or double time).
+uint8_t trackedBpm(uint8_t BeatsPerMinute)
+{
+  if (!beatDetector.validBPM)
+  {
+    return BeatsPerMinute;
+  }
+  float tempo = beatDetector.tempo;
+  while (tempo * 1.5 < BeatsPerMinute)
+  {
+    tempo *= 2;
+  }
+  while (tempo > BeatsPerMinute * 1.5)
+  {
+    tempo /= 2;
+  }
+  return tempo > 255 ? 255 : (uint8_t)(tempo + 0.5);
+}
+
+void bpm(uint8_t BeatsPerMinute)
+{
+  // colored stripes pulsing at a defined Beats-Per-Minute (BPM), following the detected tempo
+  uint8_t beat = beatsin8(trackedBpm(BeatsPerMinute), 64, 255);
+  for (int i = 0; i < NUM_LEDS; i++)
+  {
+    leds[i] = gPartyColors.color(gHue + (i * 2), beat - gHue + (i * 10));
+  }
+}
+
+void fillGradual(uint8_t BeatsPerMinute) {
+  // beatsin8(BeatsPerMinute, 0, NUM_LEDS) for any number of leds
+  uint16_t beat = (beatsin8(BeatsPerMinute) * (NUM_LEDS + 1)) >> 8;
+
+  CRGB color = gPartyColors.color(gHue, 120 + ((beat / NUM_LEDS) * 135)); // the same for all of them
+  fill_solid(leds, NUM_LEDS, CRGB::Black);
+  for (int i = 0; i < NUM_LEDS; i++)
+  {
+    if (i <= beat)
+    {
+      leds[ledAlong(i)] = color;
+
+    }
+  }
+}
+
+// Lines moving the same way in both halves of the way round the room. Distances are in 60ths
+// of a half, the length of a half in the bathroom, as 8.8 fixed point
+void wiggleLines(uint8_t BeatsPerMinute)
+{
+  int linelength = 10;
+  int moving_distance = 40;
+  int start_value = 30;
+  uint8_t beat = beatsin8(trackedBpm(BeatsPerMinute), start_value, start_value + moving_distance);
+
+  const int half = NUM_LEDS / 2;
+  fill_solid(leds, NUM_LEDS, CRGB::Black);
+  for (int i = 0; i < half; i++)
+  {
+    int distance = abs(beat * 256 - i * 60 * 256 / half);
+    if (distance < linelength * 256)
+    {
+      leds[ledAlong(i)] = gPartyColors.color(gHue, 255 - ((10 * distance) >> 8));
+      leds[ledAlong(half + i)] = leds[ledAlong(i)];
+    }
+  }
+}
+
+void flashAtBpm(uint8_t BeatsPerMinute, CHSV hsv)
+{
+  // Everything pulsing at hue in beat
+  CRGBPalette16 palette = PartyColors_p;
+  fadeToBlackBy(leds, NUM_LEDS, 5);
+  uint8_t beat = beatsin8(BeatsPerMinute, 64, 255);
+  if (beat < 67)
+  {
+    for (int i = 0; i < NUM_LEDS; i++)
+    {
+      leds[i] = hsv;
+    }
+  }
+}
+
+void flashSingle(const CRGB &color1, const CRGB &color2, const CRGB &color3, const CRGB &color4)
+{
+  uint8_t beat = beatsin8(3, 64, 255);
+  fadeToBlackBy(leds, NUM_LEDS, 5);
+  if (beat < 1)
+  {
+    quarters(color1, color2, color3, color4);
+  }
+}
+
+void juggle()
+{
+  // eight colored dots, weaving in and out of sync with each other
+  fadeToBlackBy(leds, NUM_LEDS, 20);
+  byte dothue = 0;
+  for (int i = 0; i < 8; i++)
+  {
+    leds[beatsin16(i + 7, 0, NUM_LEDS)] |= CHSV(dothue, 200, 255);
+    dothue += 32;
+  }
+}
+
+// An animation to play while the crowd goes wild after the big performance
+void applause(uint8_t width)
+{
+  uint16_t &lastPixel = gPatterns.applause.lastPixel;
+  uint8_t hue = gPatterns.applause.hue;
+  fadeToBlackBy(leds, NUM_LEDS, 32);
+  for (int i = 0; i <= width; i++)
+  {
+    leds[(lastPixel + i) % NUM_LEDS] = CHSV(hue, 255, 255);
+    leds[(lastPixel + NUM_LEDS - i) % NUM_LEDS] = CHSV(hue, 255, 255);
+  }
+
+  lastPixel = random16(NUM_LEDS);
+  for (int i = 0; i <= width; i++)
+  {
+    leds[(lastPixel + i) % NUM_LEDS] = CRGB::White;
+    leds[(lastPixel + NUM_LEDS - i) % NUM_LEDS] = CRGB::White;
+  }
+}
+
+// An "animation" to just fade to black.  Useful as the last track
+// in a non-looping performance.
+void fadeToBlack()
+{
+  fadeToBlackBy(leds, NUM_LEDS, 1);
+}
+
+//////////////////////////
+void sinelon()
+{
+  // a colored dot sweeping back and forth, with fading trails
+  fadeToBlackBy(leds, NUM_LEDS, 12);
+  int pos = beatsin16(13, 0, NUM_LEDS - 1);
+  leds[pos] += CHSV(gHue, 255, 192);
+}
+
+/////////////////////////
+void spew()
+{
+  const uint16_t spewSpeed = 100; // rate of advance
+  boolean &spewing = gPatterns.spew.spewing;
+  uint8_t &count = gPatterns.spew.count;
+  uint8_t &temp = gPatterns.spew.temp;
+  uint8_t &hue = gPatterns.spew.hue;
+  EVERY_N_MILLISECONDS(spewSpeed)
+  {
+    if (count == 0)
+    {
+      spewing = !spewing;
+      if (spewing == 1)
+      {
+        count = random8(2, 5);
+      } // random number for On pixels
+      else
+      {
+        count = random8(1, 8);
+      } // random number for Off pixels
+      temp = count;
+      // gHue = gHue - 30;
+      hue = random8();
+    }
+    for (int i = NUM_LEDS - 1; i > 0; i--)
+    {
+      leds[i] = leds[i - 1]; // shift data down the line by one pixel
+    }
+    if (spewing == 1)
+    { // new pixels are On
+      if (temp == count)
+      {
+        leds[0] = CHSV(hue - 5, 215, 255); // for first dot
+        // leds[0] = CHSV(gHue-5, 215, 255);  // for first dot
+      }
+      else
+      {
+        leds[0] = CHSV(hue, 255, 255 / (1 + ((temp - count) * 2))); // for following dots
+        // leds[0] = CHSV(gHue, 255, 255/(1+((temp-count)*2)) );  // for following dots
+      }
+    }
+    else
+    {                          // new pixels are Off
+      leds[0] = CHSV(0, 0, 0); // set pixel 0 to black
+    }
+    count = count - 1; // reduce count by one.
+  }                    // end every_n
+} // end spew
+
+//////////////////////////
+static_assert(LED_MATRIX.rows == 4, "LED_MATRIX: spewFour() spews four rows");
+
+void spewFour()
+{
+  // Similar to the abouve "spew", but split up into four sections,
+  // the rows of LED_MATRIX.
+  const uint16_t spewSpeed = 100; // rate of advance
+  uint8_t *spewing = gPatterns.spewFour.spewing; // pixels are On(1) or Off(0)
+  uint8_t *count = gPatterns.spewFour.count;     // how many to light (or not light)
+  uint8_t *temp = gPatterns.spewFour.temp;
+  uint8_t *hue = gPatterns.spewFour.hue;
+  EVERY_N_MILLISECONDS(spewSpeed)
+  {
+    for (uint8_t j = 0; j < 4; j++)
+    {
+      if (count[j] == 0)
+      {
+        if (spewing[j] == 0)
+        {
+          spewing[j] = 1;
+        }
+        else
+        {
+          spewing[j] = 0;
+        }
+        if (spewing[j] == 1)
+        {
+          count[j] = random8(2, 5);
+        } // random number for On pixels
+        else
+        {
+          count[j] = random8(1, 8);
+        } // random number for Off pixels
+        temp[j] = count[j];
+        EVERY_N_SECONDS(2)
+        { // hue going across is constant for awhile
+          hue[j] = random8();
+        }
+      }
+      for (uint8_t i = LED_MATRIX.columns - 1; i > 0; i--)
+      {
+        leds[ledMatrix(j, i)] = leds[ledMatrix(j, i - 1)]; // shift data down the line by one pixel
+      }
+      if (spewing[j] == 1)
+      { // new pixels are On
+        if (temp[j] == count[j])
+        {
+          leds[ledMatrix(j, 0)] = CHSV(hue[j] - 5, 215, 255); // for first dot
+        }
+        else
+        {
+          leds[ledMatrix(j, 0)] = CHSV(hue[j], 255, 255 / (1 + ((temp[j] - count[j]) * 2))); // for following dots
+        }
+      }
+      else
+      {                                        // new pixels are Off
+        leds[ledMatrix(j, 0)] = CHSV(0, 0, 0); // set pixel 0 to black
+      }
+      count[j] = count[j] - 1; // reduce count by one.
+    }                          // end for loop
+  }                            // end every_n
+} // end spewFour
+
+//////////////////////////
+void blinkyblink1()
+{
+  boolean &dataIncoming = gPatterns.blinkyblink1.dataIncoming;
+  boolean &blinkGate1 = gPatterns.blinkyblink1.blinkGate1;
+  boolean &blinkGate2 = gPatterns.blinkyblink1.blinkGate2;
+  int8_t &count = gPatterns.blinkyblink1.count;
+
+  EVERY_N_MILLISECONDS_I(timingObj, 250)
+  {
+    count++;
+    if (count == 6)
+    {
+      count = 0;
+    }
+    blinkGate2 = count;
+    dataIncoming = !dataIncoming;
+    blinkGate1 = !blinkGate1;
+    // Serial.print("c: "); Serial.print(count); Serial.print("\t");
+    // Serial.print(dataIncoming); Serial.print("  "); Serial.print(blinkGate1);
+    // Serial.print("\t"); Serial.print(dataIncoming * blinkGate1 * 255 * blinkGate2);
+    // Serial.print("\tb: "); Serial.print(blinkGate2); Serial.println(" ");
+    FastLED.clear();
+    leds[0] = CHSV(gHue, 0, dataIncoming * blinkGate1 * 255 * blinkGate2);
+    if (count == 2 || count == 3)
+    {
+      timingObj.setPeriod(50);
+    }
+    else if (count == 4)
+    {
+      timingObj.setPeriod(405);
+    }
+    else
+    {
+      timingObj.setPeriod(165);
+    }
+  }
+} // end_blinkyblink1
+
+//////////////////////////
+void blinkyblink2()
+{
+  boolean &dataIncoming = gPatterns.blinkyblink2.dataIncoming;
+  boolean &blinkGate1 = gPatterns.blinkyblink2.blinkGate1;
+  boolean &blinkGate2 = gPatterns.blinkyblink2.blinkGate2;
+  int8_t &count = gPatterns.blinkyblink2.count;
+  uint16_t &P = gPatterns.blinkyblink2.P;
+
+  EVERY_N_MILLISECONDS_I(timingObj, 250)
+  {
+    count++;
+    if (count == 8)
+    {
+      count = 0;
+      P = (random8() * NUM_LEDS) >> 8; // random8(NUM_LEDS) for any number of leds
+    }
+    blinkGate2 = count;
+    dataIncoming = !dataIncoming;
+    blinkGate1 = !blinkGate1;
+    // Serial.print("c: "); Serial.print(count); Serial.print("\t");
+    // Serial.print(dataIncoming); Serial.print("  "); Serial.print(blinkGate1);
+    // Serial.print("\t"); Serial.print(dataIncoming * blinkGate1 * 255 * blinkGate2);
+    // Serial.print("\tb: "); Serial.print(blinkGate2); Serial.println(" ");
+    FastLED.clear();
+    leds[P] = CHSV(gHue, 255, dataIncoming * blinkGate1 * 255 * blinkGate2);
+    if (count == 6)
+    {
+      timingObj.setPeriod(250);
+    }
+    else if (count == 7)
+    {
+      timingObj.setPeriod(500);
+    }
+    else
+    {
+      timingObj.setPeriod(25);
+    }
+  }
+} // end_blinkyblink2
+
+//////////////////////////
+void fillAndCC()
+{
+  int16_t &pos = gPatterns.fillAndCC.pos;
+  int8_t &delta = gPatterns.fillAndCC.delta;
+  uint8_t &hue = gPatterns.fillAndCC.hue;
+  EVERY_N_MILLISECONDS(50)
+  {
+    leds[pos] = CHSV(hue, 255, 255);
+    pos = (pos + delta + NUM_LEDS) % NUM_LEDS;
+    if (delta >= 0 && pos == 0)
+    { // going forward
+      hue = hue + random8(42, 128);
+    }
+    if (delta < 0 && pos == NUM_LEDS - 1)
+    { // going backward
+      hue = hue + random8(42, 128);
+    }
+  }
+} // fillAndCC
+
+//////////////////////////
+void twoDots()
+{
+  uint16_t &pos = gPatterns.twoDots.pos;
+  EVERY_N_MILLISECONDS(70)
+  {
+    fadeToBlackBy(leds, NUM_LEDS, 200); // fade all the pixels some
+    leds[pos] = CHSV(gHue, random8(170, 230), 255);
+    leds[(pos + 5) % NUM_LEDS] = CHSV(gHue + 64, random8(170, 230), 255);
+    pos = pos + 1; // advance position
+
+    // This following check is very important.  Do not go past the last pixel!
+    if (pos == NUM_LEDS)
+    {
+      pos = 0;
+    } // reset to beginning
+    // Trying to write data to non-existent pixels causes bad things.
+  }
+} // end_twoDots
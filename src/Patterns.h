@@ -0,0 +1,89 @@
+/*
+ * The led patterns the cues run (see runCue() in Shows.cpp). They draw into leds[]
+ * and keep what they need from one frame to the next in gPatterns.
+ */
+
+#ifndef PATTERNS_H
+#define PATTERNS_H
+
+#include <FastLED.h>
+#include "BeatDetector.h"
+#include "LedLayout.h"
+#include "PaletteCache.h"
+
+extern CRGB leds[NUM_LEDS];
+extern CRGBSet ledset;
+extern uint8_t gHue; // rotating "base color" used by many of the patterns
+extern PaletteCache gPartyColors; // PartyColors_p, what the patterns draw with
+extern BeatDetector beatDetector; // main.cpp, or the host renderer
+
+// What the patterns remember from one frame to the next, all in one place so a seek
+// can start them over (resetPatterns) before it replays the show up to the new position.
+struct PatternState
+{
+  struct
+  {
+    uint16_t lastPixel = 0;
+    uint8_t hue = 0;
+  } applause;
+  struct
+  {
+    boolean spewing = 0; // pixels are On(1) or Off(0)
+    uint8_t count = 1;   // how many to light (or not light)
+    uint8_t temp = 1;
+    uint8_t hue = 0;
+  } spew;
+  struct
+  {
+    uint8_t spewing[4] = {0, 0, 0, 0};
+    uint8_t count[4] = {1, 1, 1, 1};
+    uint8_t temp[4] = {1, 1, 1, 1};
+    uint8_t hue[4] = {0, 0, 0, 0};
+  } spewFour;
+  struct
+  {
+    boolean dataIncoming = LOW;
+    boolean blinkGate1 = LOW;
+    boolean blinkGate2 = HIGH;
+    int8_t count = -1;
+    uint16_t P = 0;
+  } blinkyblink1, blinkyblink2;
+  struct
+  {
+    int16_t pos = 0;  // position along strip
+    int8_t delta = 3; // delta (can be negative, and/or odd numbers)
+    uint8_t hue = 0;  // hue to display
+  } fillAndCC;
+  struct
+  {
+    uint16_t pos = 0; // used to keep track of position
+  } twoDots;
+};
+extern PatternState gPatterns;
+void resetPatterns(); // back to how the patterns start, after random16_set_seed()
+
+void quarters(const CRGB &color1, const CRGB &color2, const CRGB &color3, const CRGB &color4);
+void pulsing();
+void rainbow();
+void rainbowWithGlitter();
+void addGlitter(fract8 chanceOfGlitter);
+void confetti();
+void bpm(uint8_t BeatsPerMinute);
+void juggle();
+void applause(uint8_t width);
+void fadeToBlack();
+void twoDots();
+void fillAndCC();
+void blinkyblink2();
+void spewFour();
+void spew();
+void sinelon();
+void flashAtBpm(uint8_t BeatsPerMinute, CHSV hue);
+void wiggleLines(uint8_t BeatsPerMinute);
+void flashPulsing();
+void fillGradual(uint8_t BeatsPerMinute);
+void flashSingle(const CRGB &color1, const CRGB &color2, const CRGB &color3, const CRGB &color4);
+void blinkyblink1();
+uint8_t trackedBpm(uint8_t BeatsPerMinute);
+
+#endif // PATTERNS_H
@@ -0,0 +1,109 @@
+/*
+ * Which song comes next.
+ *
+ * Songs asked for with queue() come first, in the order they were asked for, and follow
+ * the song before them without a button press. Otherwise it's the next song of a
+ * shuffled order of all songs, so every song comes once before any comes twice, and the
+ * last of one round never starts the next.
+ *
+ * upcoming() can be looked at as often as needed (the next song is opened ahead of time,
+ * WavPlayer::preload()), advance() moves on once it actually started.
+ */
+
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <Arduino.h>
+
+class Playlist
+{
+public:
+    static const uint8_t MAX_SONGS = 32;
+    static const uint8_t MAX_QUEUED = 8;
+
+    void begin(uint8_t songs)
+    {
+        songCount = songs < MAX_SONGS ? songs : MAX_SONGS;
+        queuedCount = 0;
+        shuffle(songCount);
+    }
+
+    // plays song after the one that is playing now, or the ones queued before it. false when full
+    bool queue(uint8_t song)
+    {
+        if (song >= songCount || queuedCount == MAX_QUEUED)
+        {
+            return false;
+        }
+        queued[queuedCount++] = song;
+        return true;
+    }
+
+    uint8_t upcoming() const { return queuedCount ? queued[0] : order[position]; }
+    bool upcomingQueued() const { return queuedCount > 0; } // follows the playing song by itself
+
+    // upcoming() started playing
+    void advance()
+    {
+        if (queuedCount)
+        {
+            memmove(queued, queued + 1, --queuedCount);
+            return;
+        }
+        uint8_t played = order[position];
+        if (++position >= songCount)
+        {
+            shuffle(played);
+        }
+    }
+
+private:
+    // a new round, one that doesn't start with last
+    void shuffle(uint8_t last)
+    {
+        seed ^= micros(); // when the song before was started
+        if (!seed)
+        {
+            seed = 1;
+        }
+        position = 0;
+        if (!songCount)
+        {
+            return;
+        }
+        for (uint8_t i = 0; i < songCount; i++)
+        {
+            order[i] = i;
+        }
+        for (uint8_t i = songCount - 1; i > 0; i--)
+        {
+            uint8_t j = nextRandom() % (i + 1);
+            uint8_t swap = order[i];
+            order[i] = order[j];
+            order[j] = swap;
+        }
+        if (songCount > 1 && order[0] == last)
+        {
+            order[0] = order[1];
+            order[1] = last;
+        }
+    }
+
+    uint32_t nextRandom()
+    {
+        // xorshift32, FastLED's random8() is reseeded by every seek
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    uint8_t songCount = 0;
+    uint8_t order[MAX_SONGS];
+    uint8_t position = 0;
+    uint8_t queued[MAX_QUEUED];
+    uint8_t queuedCount = 0;
+    uint32_t seed = 2463534242u;
+};
+
+#endif // PLAYLIST_H
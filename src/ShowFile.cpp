@@ -0,0 +1,76 @@
+#include "ShowFile.h"
+#include "Sidecar.h"
+
+bool ShowFile::open(const char *wavFilename)
+{
+    close();
+
+    char name[64];
+    sidecarName(wavFilename, ".show", name, sizeof(name));
+    if (!openSidecar(file, name))
+    {
+        return false;
+    }
+
+    ShowFileHeader header;
+    int bytes = sidecarRead(file, &header, sizeof(header));
+    if (bytes != sizeof(header) || memcmp(header.magic, SHOWFILE_MAGIC, 4) || header.version != SHOWFILE_VERSION)
+    {
+        Serial.print(name);
+        Serial.println(" is not a show file");
+        sidecarClose(file);
+        return false;
+    }
+
+    cueCount = header.cueCount;
+    opened = true;
+    rewind();
+    return true;
+}
+
+void ShowFile::rewind()
+{
+    if (opened)
+    {
+        sidecarSeek(file, sizeof(ShowFileHeader));
+    }
+    cuesLeft = cueCount;
+    buffered = 0;
+    bufferIndex = 0;
+}
+
+void ShowFile::close()
+{
+    if (opened)
+    {
+        sidecarClose(file);
+    }
+    opened = false;
+}
+
+bool ShowFile::next(Cue &cue)
+{
+    if (!opened)
+    {
+        return false;
+    }
+    if (bufferIndex >= buffered)
+    {
+        int count = cuesLeft < BUFFERED_CUES ? cuesLeft : BUFFERED_CUES;
+        if (count == 0)
+        {
+            return false;
+        }
+        int bytes = sidecarRead(file, buffer, count * sizeof(Cue));
+        buffered = bytes / sizeof(Cue);
+        bufferIndex = 0;
+        cuesLeft -= buffered;
+        if (buffered == 0)
+        {
+            cuesLeft = 0;
+            return false;
+        }
+    }
+    cue = buffer[bufferIndex++];
+    return true;
+}
@@ -0,0 +1,36 @@
+/*
+ * Streams a .show file (ShowFileFormat.h) from the sd card into CuePlayer.
+ *
+ * Only BUFFERED_CUES cues are in RAM at a time, refilled from the file as the song
+ * goes on, so a long show costs no more memory than a short one.
+ */
+
+#ifndef SHOWFILE_H
+#define SHOWFILE_H
+
+#include <SD.h>
+#include "ShowFileFormat.h"
+
+class ShowFile : public CueSource
+{
+public:
+    bool open(const char *wavFilename); // opens the show of wavFilename (song.wav -> song.show), false if there is none
+    void close();
+    bool isOpen() { return opened; }
+
+    bool next(Cue &cue) override;
+    void rewind() override;
+
+private:
+    File file;
+    bool opened = false;
+    uint32_t cueCount = 0;
+    uint32_t cuesLeft = 0; // still in the file
+
+    static const int BUFFERED_CUES = 16;
+    Cue buffer[BUFFERED_CUES];
+    int buffered = 0;
+    int bufferIndex = 0;
+};
+
+#endif // SHOWFILE_H
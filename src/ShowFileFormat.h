@@ -0,0 +1,39 @@
+/*
+ * .show file format: a cue table (Cue.h) on the sd card next to its song, song.wav -> song.show.
+ *
+ * Written by tools/showc.py from a text show (song.cues, see the top of showc.py) and
+ * streamed by ShowFile during playback, so timing can be changed by copying a file
+ * instead of reflashing:
+ *
+ *   ShowFileHeader
+ *   Cue[cueCount]   sorted by time, the same 24 byte struct the firmware uses
+ *
+ * Little endian like the teensy. Actions are CueAction numbers, new actions only get
+ * added at the end of the enum so old show files keep working. The transition bytes
+ * were padding before transitions existed and are 0 (TRANSITION_CUT) in older files.
+ */
+
+#ifndef SHOWFILEFORMAT_H
+#define SHOWFILEFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Cue.h"
+
+#define SHOWFILE_MAGIC "SHOW"
+#define SHOWFILE_VERSION 1
+
+struct ShowFileHeader
+{
+    char magic[4];     // SHOWFILE_MAGIC
+    uint16_t version;  // SHOWFILE_VERSION
+    uint16_t reserved;
+    uint32_t cueCount;
+};
+
+static_assert(sizeof(ShowFileHeader) == 12, "ShowFileHeader must be packed");
+static_assert(sizeof(Cue) == 24 && offsetof(Cue, kind) == 4 && offsetof(Cue, action) == 5 && offsetof(Cue, transition) == 6 &&
+                  offsetof(Cue, transitionLength) == 7 && offsetof(Cue, args) == 8,
+              "Cue layout is part of the .show format");
+
+#endif // SHOWFILEFORMAT_H
@@ -0,0 +1,361 @@
+#include "Shows.h"
+#include "Crossfader.h"
+#include "Patterns.h"
+#include "TempoMap.h"
+
+uint32_t gShowMillis = 0;
+// gHue runs on the song position: gHueStart at gHueStartTime, one step every 20 ms after that
+static uint8_t gHueStart = 0;
+static uint32_t gHueStartTime = 0;
+static CuePlayer cuePlayer;                   // plays the current show's cues
+static Crossfader<NUM_LEDS> crossfader(leds); // blends FROM segments into each other, see the transitions in Cue.h
+
+// FastLED's clock (-D USE_GET_MILLISECOND_TIMER), so the patterns move with the song and
+// a seek can replay them
+uint32_t get_millisecond_timer()
+{
+  return gShowMillis;
+}
+
+// The shows. Each is a cue table (see Cue.h) played by cuePlayer against the song position:
+//
+// * "FROM_CUE" means starting FROM this time AND CALLING IT REPEATEDLY
+//   until the next "FROM_CUE" time comes.
+//
+// * "AT_CUE" means do this ONE TIME ONLY "AT" the designated time.
+//
+// At least one of the FROM cues will ALWAYS be executed once the first one is reached.
+// Only the latest FROM runs, so at a transition the old one stops in the same frame
+// the new one starts, unless the new one is a FROM_CUE_BLEND: then both run for a while
+// and crossfader blends them. runCue() below is what each action does.
+// Stayin' Alive is 103 bpm all the way through, bar 10 is where the quarters start
+constexpr TempoSection stayinAliveTempo[] = {
+  TEMPO_START(02.211, 103, 4),
+};
+static_assert(tempoMapValid(stayinAliveTempo), "stayinAliveTempo: bars out of order");
+
+constexpr Cue stayinAlive[] = {
+  AT_CUE(0, 0, 00.001, CUE_BRIGHTNESS, BRIGHTNESS),
+  FROM_CUE(0, 0, 00.120, CUE_BPM, 103),
+  FROM_BAR(stayinAliveTempo, 10, 1, 0, CUE_QUARTERS, CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black),
+  FROM_BAR(stayinAliveTempo, 10, 2, 0, CUE_QUARTERS, CRGB::Red, CRGB::Green, CRGB::Black, CRGB::Black),
+  FROM_BAR(stayinAliveTempo, 10, 3, 0, CUE_QUARTERS, CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Black),
+  FROM_BAR(stayinAliveTempo, 10, 4, 0, CUE_QUARTERS, CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Yellow),
+  FROM_BAR(stayinAliveTempo, 11, 1, 0, CUE_PULSING),
+  FROM_BAR(stayinAliveTempo, 12, 1, 0, CUE_FILL, CRGB::Orange),
+  FROM_BAR(stayinAliveTempo, 12, 2, 0, CUE_FILL, CRGB::White),
+  FROM_BAR(stayinAliveTempo, 12, 3, 0, CUE_FILL, CRGB::Blue),
+  FROM_BAR(stayinAliveTempo, 12, 4, 0, CUE_FILL, CRGB::Pink),
+  FROM_BAR(stayinAliveTempo, 12, 4, 68, CUE_PULSING),
+  FROM_BAR(stayinAliveTempo, 14, 1, 0, CUE_QUARTERS, CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black),
+  FROM_BAR(stayinAliveTempo, 14, 2, 0, CUE_QUARTERS, CRGB::Red, CRGB::Green, CRGB::Black, CRGB::Black),
+  FROM_BAR(stayinAliveTempo, 14, 3, 0, CUE_QUARTERS, CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Black),
+  FROM_BAR(stayinAliveTempo, 14, 4, 0, CUE_QUARTERS, CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Yellow),
+  FROM_BAR(stayinAliveTempo, 15, 1, 0, CUE_PULSING),
+  FROM_BAR(stayinAliveTempo, 16, 1, 0, CUE_FILL, CRGB::Orange),
+  FROM_BAR(stayinAliveTempo, 16, 2, 0, CUE_FILL, CRGB::White),
+  FROM_BAR(stayinAliveTempo, 16, 3, 0, CUE_FILL, CRGB::Blue),
+  FROM_BAR(stayinAliveTempo, 16, 4, 0, CUE_FILL, CRGB::Pink),
+  FROM_BAR(stayinAliveTempo, 17, 1, 0, CUE_PULSING),
+  // FROM_BAR(stayinAliveTempo, 17, 1, 0, CUE_BPM, 103),
+  FROM_CUE(0, 0, 49.800, CUE_FADE, 1),
+};
+static_assert(cuesSorted(stayinAlive), "stayinAlive: cues out of order");
+
+constexpr Cue celebrate[] = {
+  AT_CUE(0, 0, 00.001, CUE_BRIGHTNESS, BRIGHTNESS),
+  FROM_CUE(0, 0, 00.012, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black),
+
+  FROM_CUE(0, 0, 1.06, CUE_BPM, 60),
+  FROM_CUE(0, 0, 5.620, CUE_FILL_GRADUAL, 30),
+  FROM_CUE(0, 0, 7.149, CUE_BPM, 60),
+
+  FROM_CUE(0, 0, 9.175, CUE_QUARTERS, CRGB::Salmon, CRGB::Black, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 9.667, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Blue, CRGB::Black),
+  FROM_CUE(0, 0, 10.185, CUE_QUARTERS, CRGB::Black, CRGB::Green, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 10.677, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Orange),
+
+  FROM_CUE(0, 0, 11.185, CUE_QUARTERS, CRGB::Black, CRGB::Salmon, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 11.435, CUE_QUARTERS, CRGB::Black, CRGB::Salmon, CRGB::LightBlue, CRGB::Black),
+  FROM_CUE(0, 0, 11.682, CUE_QUARTERS, CRGB::Lime, CRGB::Salmon, CRGB::LightBlue, CRGB::Black),
+  FROM_CUE(0, 0, 11.938, CUE_QUARTERS, CRGB::Lime, CRGB::Salmon, CRGB::LightBlue, CRGB::Red),
+
+  FROM_CUE(0, 0, 13.222, CUE_BPM, 60),
+  FROM_CUE(0, 0, 16.471, CUE_APPLAUSE, 30),
+
+  FROM_CUE(0, 0, 17.220, CUE_BPM, 60),
+  FROM_CUE(0, 0, 20.704, CUE_WIGGLE_LINES, 60),
+
+  FROM_CUE(0, 0, 21.692, CUE_BPM, 60),
+
+  FROM_CUE(0, 0, 25.188, CUE_QUARTERS, CRGB::Salmon, CRGB::Black, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 25.667, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Blue, CRGB::Black),
+  FROM_CUE(0, 0, 26.185, CUE_QUARTERS, CRGB::Black, CRGB::Green, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 26.677, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Orange),
+
+  FROM_CUE(0, 0, 27.185, CUE_QUARTERS, CRGB::Black, CRGB::Salmon, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 27.435, CUE_QUARTERS, CRGB::Black, CRGB::Salmon, CRGB::LightBlue, CRGB::Black),
+  FROM_CUE(0, 0, 27.682, CUE_QUARTERS, CRGB::Lime, CRGB::Salmon, CRGB::LightBlue, CRGB::Black),
+  FROM_CUE(0, 0, 27.938, CUE_QUARTERS, CRGB::Lime, CRGB::Salmon, CRGB::LightBlue, CRGB::Red),
+
+  FROM_CUE(0, 0, 28.645, CUE_WIGGLE_LINES, 60),
+
+  FROM_CUE(0, 0, 29.644, CUE_BPM, 60),
+  FROM_CUE(0, 0, 46.5, CUE_FADE, 1),
+};
+static_assert(cuesSorted(celebrate), "celebrate: cues out of order");
+
+constexpr Cue astro[] = {
+  AT_CUE(0, 0, 00.001, CUE_BRIGHTNESS, BRIGHTNESS),
+
+  FROM_CUE(0, 0, 00.012, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black),
+
+  FROM_CUE(0, 0, 0.983, CUE_FLASH_PULSING),
+  FROM_CUE(0, 0, 05.454, CUE_WIGGLE_LINES, 127),
+  FROM_CUE(0, 0, 06.604, CUE_FLASH_PULSING),
+  FROM_CUE(0, 0, 07.348, CUE_WIGGLE_LINES, 127),
+  FROM_CUE(0, 0, 08.546, CUE_FLASH_PULSING),
+  FROM_CUE(0, 0, 13.086, CUE_WIGGLE_LINES, 127),
+  FROM_CUE(0, 0, 14.276, CUE_FLASH_PULSING),
+  FROM_CUE(0, 0, 14.982, CUE_WIGGLE_LINES, 127),
+  FROM_CUE(0, 0, 16.189, CUE_FLASH_PULSING),
+  FROM_CUE(0, 0, 20.697, CUE_WIGGLE_LINES, 127),
+  FROM_CUE(0, 0, 21.983, CUE_FLASH_PULSING),
+  FROM_CUE(0, 0, 22.622, CUE_WIGGLE_LINES, 127),
+  FROM_CUE(0, 0, 23.8, CUE_FLASH_PULSING),
+  FROM_CUE(0, 0, 27.454, CUE_APPLAUSE, 1),
+  AT_CUE(0, 0, 30.215, CUE_FILL, CRGB::White), // single flash
+  FROM_CUE(0, 0, 30.220, CUE_FADE, 2),
+  FROM_CUE(0, 0, 30.8, CUE_FADE, 1),
+};
+static_assert(cuesSorted(astro), "astro: cues out of order");
+
+constexpr Cue ramaLama[] = {
+  AT_CUE(0, 0, 00.001, CUE_BRIGHTNESS, BRIGHTNESS),
+
+  // Rama Lam
+  FROM_CUE(0, 0, 01.100, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black),
+  // Ding Dong
+  FROM_CUE(0, 0, 01.629, CUE_QUARTERS, CRGB::LawnGreen, CRGB::Black, CRGB::LawnGreen, CRGB::Black),
+  FROM_CUE(0, 0, 02.085, CUE_QUARTERS, CRGB::Black, CRGB::Salmon, CRGB::Black, CRGB::Salmon),
+
+  // Rama Lam
+  FROM_CUE(0, 0, 02.587, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black),
+  // Ding Ding Dong
+  FROM_CUE(0, 0, 03.604, CUE_QUARTERS, CRGB::Salmon, CRGB::Black, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 03.860, CUE_QUARTERS, CRGB::Salmon, CRGB::Black, CRGB::Salmon, CRGB::Black),
+  FROM_CUE(0, 0, 04.094, CUE_QUARTERS, CRGB::Black, CRGB::LawnGreen, CRGB::Black, CRGB::LawnGreen),
+
+  // Ramalamalamalamalamadingdong Ramalamalamalamalamading
+  FROM_CUE(0, 0, 04.621, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black),
+  // Uhuh Uhuhuh Uhuhuhuh Uhuhuhuhuhuhu
+  FROM_CUE(0, 0, 08.454, CUE_BPM, 127),
+  // Uuuuh Aaaaah
+  FROM_CUE(0, 0, 19.880, CUE_BPM, 254),
+  // Ah.
+  FROM_CUE(0, 0, 21.730, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black),
+
+  // O ohoh ohoh ohoh
+  FROM_CUE(0, 0, 22.228, CUE_QUARTERS, CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 22.702, CUE_QUARTERS, CRGB::Red, CRGB::Green, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 23.304, CUE_QUARTERS, CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Black),
+
+  // Ive got a girl named
+  FROM_CUE(0, 0, 23.610, CUE_BPM, 127),
+
+  // Rama Lama Lama Lama
+  FROM_CUE(0, 0, 25.731, CUE_APPLAUSE, 5),
+  // Ding Dong
+  FROM_CUE(0, 0, 26.968, CUE_QUARTERS, CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 27.187, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Red, CRGB::Black),
+  // She said a thing to me
+  FROM_CUE(0, 0, 27.450, CUE_BPM, 127),
+  // Rama Lama Lama Lama
+  FROM_CUE(0, 0, 29.5, CUE_APPLAUSE, 5),
+  // Ding Dong
+  FROM_CUE(0, 0, 30.742, CUE_QUARTERS, CRGB::Black, CRGB::Green, CRGB::Black, CRGB::Black),
+  FROM_CUE(0, 0, 31.013, CUE_QUARTERS, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Green),
+
+  // I never set her free, cause shes mine oh
+  FROM_CUE(0, 0, 31.261, CUE_BPM, 127),
+  // Miiiiine
+  FROM_CUE(0, 0, 34.985, CUE_APPLAUSE, 1),
+  // Uuuuuuha aaaaaaaah
+
+  FROM_CUE(0, 0, 34.985, CUE_APPLAUSE, 1),
+  AT_CUE(0, 0, 37, CUE_BRIGHTNESS, BRIGHTNESS / 2),
+  FROM_CUE(0, 0, 37, CUE_APPLAUSE, 2),
+  AT_CUE(0, 0, 38, CUE_BRIGHTNESS, BRIGHTNESS / 4),
+  FROM_CUE(0, 0, 38, CUE_APPLAUSE, 3),
+  AT_CUE(0, 0, 39, CUE_BRIGHTNESS, BRIGHTNESS / 6),
+  FROM_CUE(0, 0, 39, CUE_APPLAUSE, 4),
+  AT_CUE(0, 0, 40, CUE_BRIGHTNESS, BRIGHTNESS / 8),
+  AT_CUE(0, 0, 41, CUE_BRIGHTNESS, BRIGHTNESS / 10),
+  FROM_CUE(0, 0, 41, CUE_APPLAUSE, 5),
+  FROM_CUE(0, 0, 41.5, CUE_FADE, 1),
+
+  // aaaaaaaaah
+};
+static_assert(cuesSorted(ramaLama), "ramaLama: cues out of order");
+
+constexpr Cue demo[] = {
+  AT_CUE(0, 0, 00.001, CUE_BRIGHTNESS, BRIGHTNESS),
+  FROM_CUE(0, 0, 01.500, CUE_JUGGLE),
+  FROM_CUE_BLEND(0, 0, 03.375, TRANSITION_FADE, 50, CUE_RAINBOW_GLITTER),
+  FROM_CUE_BLEND(0, 0, 04.333, TRANSITION_BEAT, 2, CUE_BPM, 62),
+  FROM_CUE_BLEND(0, 0, 06.666, TRANSITION_WIPE, 25, CUE_JUGGLE),
+  FROM_CUE(0, 0, 08.750, CUE_CONFETTI),
+  AT_CUE(0, 0, 11.000, CUE_HUE, HUE_PINK),
+  AT_CUE(0, 0, 12.000, CUE_FILL, CRGB::Red),
+  AT_CUE(0, 0, 15.000, CUE_FILL, CRGB::Blue),
+  FROM_CUE(0, 0, 16.500, CUE_FADE_TO_BLACK),
+  FROM_CUE(0, 0, 18.000, CUE_APPLAUSE, 1),
+  AT_CUE(0, 0, 19.000, CUE_BRIGHTNESS, BRIGHTNESS / 2),
+  AT_CUE(0, 0, 20.000, CUE_BRIGHTNESS, BRIGHTNESS / 4),
+  AT_CUE(0, 0, 21.000, CUE_BRIGHTNESS, BRIGHTNESS / 8),
+  AT_CUE(0, 0, 22.000, CUE_BRIGHTNESS, BRIGHTNESS / 16),
+  FROM_CUE(0, 0, 23.000, CUE_FADE_TO_BLACK),
+};
+static_assert(cuesSorted(demo), "demo: cues out of order");
+
+// List of shows to pick from, each song with its cue table.
+const Show gShows[] = {
+  SHOW("rldd.wav", ramaLama),
+  SHOW("test2.wav", stayinAlive),
+  SHOW("astro.wav", astro),
+  SHOW("seleb.wav", celebrate),
+};
+const uint8_t gNumberOfPatterns = sizeof(gShows) / sizeof(gShows[0]);
+
+void runCue(const Cue &cue)
+{
+  switch (cue.action)
+  {
+  case CUE_BRIGHTNESS:
+    FastLED.setBrightness(cue.args[0]);
+    break;
+  case CUE_HUE:
+    gHue = gHueStart = cue.args[0];
+    gHueStartTime = cue.time;
+    break;
+  case CUE_FILL:
+    fill_solid(leds, NUM_LEDS, CRGB(cue.args[0]));
+    break;
+  case CUE_FADE:
+    fadeToBlackBy(leds, NUM_LEDS, cue.args[0]);
+    break;
+  case CUE_QUARTERS:
+    quarters(CRGB(cue.args[0]), CRGB(cue.args[1]), CRGB(cue.args[2]), CRGB(cue.args[3]));
+    break;
+  case CUE_BPM:
+    bpm(cue.args[0]);
+    break;
+  case CUE_PULSING:
+    pulsing();
+    break;
+  case CUE_FLASH_PULSING:
+    flashPulsing();
+    break;
+  case CUE_FILL_GRADUAL:
+    fillGradual(cue.args[0]);
+    break;
+  case CUE_WIGGLE_LINES:
+    wiggleLines(cue.args[0]);
+    break;
+  case CUE_APPLAUSE:
+    applause(cue.args[0]);
+    break;
+  case CUE_JUGGLE:
+    juggle();
+    break;
+  case CUE_RAINBOW_GLITTER:
+    rainbowWithGlitter();
+    break;
+  case CUE_CONFETTI:
+    confetti();
+    break;
+  case CUE_FADE_TO_BLACK:
+    fadeToBlack();
+    break;
+  }
+}
+
+// the cues before a seek's settle window: only what lasts longer than a frame matters there
+static void runStateCue(const Cue &cue)
+{
+  if (cue.action == CUE_BRIGHTNESS || cue.action == CUE_HUE)
+  {
+    runCue(cue);
+  }
+}
+
+static void skipCue(const Cue &)
+{
+}
+
+void renderFrame(uint32_t position, CuePlayer::CueRunner run, const CRGB *cached)
+{
+  gShowMillis = position;
+  gHue = gHueStart + (position - gHueStartTime) / 20; // slowly cycle the "base color" through the rainbow
+  crossfader.beginFrame();
+  cuePlayer.advance(position, run);
+  if (cached)
+  {
+    // the FROM cues drew this when the cache was rendered. crossfader still gets to keep
+    // the frame, for the segment after
+    memcpy(leds, cached, sizeof(CRGB) * NUM_LEDS);
+    crossfader.render(cuePlayer, skipCue, position, beatDetector);
+    return;
+  }
+  crossfader.render(cuePlayer, run, position, beatDetector);
+}
+
+// actions that draw every led from the song position and gHue alone, whatever was on the strip
+// before. not bpm() or wiggleLines(): they follow the tempo beatDetector finds, which differs
+// between the host render and the teensy
+static bool redrawsStrip(uint8_t action)
+{
+  switch (action)
+  {
+  case CUE_FILL:
+  case CUE_QUARTERS:
+  case CUE_FILL_GRADUAL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool cacheableFrame()
+{
+  if (crossfader.transitioning() || !cuePlayer.fromCueCount())
+  {
+    return false;
+  }
+  for (int i = 0; i < cuePlayer.fromCueCount(); i++)
+  {
+    if (!redrawsStrip(cuePlayer.fromCues()[i].action))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void rebuildShow(CueSource &cues, uint32_t position, uint32_t framePeriodMicros)
+{
+  cuePlayer.start(cues);
+  crossfader.reset();
+  gHueStart = 0;
+  gHueStartTime = 0;
+  random16_set_seed(position); // the same seek always looks the same
+  resetPatterns();
+  fill_solid(leds, NUM_LEDS, CRGB::Black);
+
+  uint32_t settle = position > SEEK_SETTLE_MS ? position - SEEK_SETTLE_MS : 0;
+  cuePlayer.advance(settle, runStateCue);
+  for (uint32_t frame = settle * 1000 / framePeriodMicros; frame * framePeriodMicros < position * 1000; frame++)
+  {
+    renderFrame(frame * framePeriodMicros / 1000);
+  }
+}
@@ -0,0 +1,47 @@
+/*
+ * The shows and everything that draws them, from a song position to leds[].
+ *
+ * Kept apart from main.cpp so the host renderer (src/host/render.cpp) runs the same
+ * code as the teensy: main.cpp only adds the audio, the sd card and the strip.
+ */
+
+#ifndef SHOWS_H
+#define SHOWS_H
+
+#include <FastLED.h>
+#include "Cue.h"
+#include "CuePlayer.h"
+
+#define BRIGHTNESS 96
+#ifndef FRAMES_PER_SECOND
+#define FRAMES_PER_SECOND 120 // frame grid on the song time, a frame takes the strip about 3.9 ms to show (LedLayout.h)
+#endif
+
+// Seeking rebuilds what is on the strip by running the show, without showing it, over the
+// last SEEK_SETTLE_MS before the new position, frame by frame on the frame grid. That is
+// long enough for the fading patterns to forget what came before, the cues before it
+// only get their brightness and hue applied.
+#define SEEK_SETTLE_MS 500
+
+extern const Show gShows[];
+extern const uint8_t gNumberOfPatterns;
+
+extern uint32_t gShowMillis; // song position of the frame being drawn, FastLED's clock
+
+// what the actions in the cue tables do
+void runCue(const Cue &cue);
+
+// draws the show at song position into leds. run is runCue, or something that calls it.
+// cached is the pre-rendered frame for position if there is one (FrameCache), it takes
+// the place of the FROM cues
+void renderFrame(uint32_t position, CuePlayer::CueRunner run = runCue, const CRGB *cached = nullptr);
+
+// true when the frame renderFrame() just drew depends on nothing but its song position: only
+// FROM cues that redraw the whole strip, no transition. those can be cached
+bool cacheableFrame();
+
+// starts cues over and rebuilds the show as if it had played up to position: cues,
+// crossfades, gHue and the patterns' own state. position 0 is the start of a song
+void rebuildShow(CueSource &cues, uint32_t position, uint32_t framePeriodMicros);
+
+#endif // SHOWS_H
@@ -0,0 +1,71 @@
+/*
+ * Files that belong to a song sit next to its wav with another extension:
+ * song.wav -> song.beats (BeatMap), song.show (ShowFile), song.cache (FrameCache).
+ *
+ * They are read from loop() while a song plays, and the sd card is shared with
+ * WavPlayer::update(), which reads the song in the audio interrupt. So every access to
+ * a sidecar goes through the functions below, each one short block with the audio
+ * interrupt held off (SdAccess) like WavPlayer::preload(), never a whole file.
+ */
+
+#ifndef SIDECAR_H
+#define SIDECAR_H
+
+#include <Audio.h>
+#include <SD.h>
+#include <string.h>
+
+// holds off the audio interrupt for as long as it is in scope
+struct SdAccess
+{
+    SdAccess() { AudioNoInterrupts(); }
+    ~SdAccess() { AudioInterrupts(); }
+    SdAccess(const SdAccess &) = delete;
+    SdAccess &operator=(const SdAccess &) = delete;
+};
+
+// name of wavFilename's sidecar with extension (".beats"), cut short to fit size
+inline void sidecarName(const char *wavFilename, const char *extension, char *name, size_t size)
+{
+    size_t keep = size - strlen(extension) - 1;
+    strncpy(name, wavFilename, keep);
+    name[keep] = 0;
+    char *dot = strrchr(name, '.');
+    if (dot)
+    {
+        *dot = 0;
+    }
+    strcat(name, extension);
+}
+
+// opens name into file, false if it isn't on the sd card
+inline bool openSidecar(File &file, const char *name)
+{
+    SdAccess sd;
+    if (!SD.exists(name))
+    {
+        return false;
+    }
+    file = SD.open(name);
+    return (bool)file;
+}
+
+inline int sidecarRead(File &file, void *data, size_t size)
+{
+    SdAccess sd;
+    return file.read(data, size);
+}
+
+inline void sidecarSeek(File &file, uint32_t position)
+{
+    SdAccess sd;
+    file.seek(position);
+}
+
+inline void sidecarClose(File &file)
+{
+    SdAccess sd;
+    file.close();
+}
+
+#endif // SIDECAR_H
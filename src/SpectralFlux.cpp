@@ -0,0 +1,116 @@
+#include "SpectralFlux.h"
+
+#include <string.h>
+
+#if defined(__ARM_ARCH_7EM__)
+#define SPECTRALFLUX_ARM_DSP
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SPECTRALFLUX_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SPECTRALFLUX_NEON
+#endif
+
+uint32_t spectralFluxScalar(const uint16_t *current, uint16_t *previous, const int16_t *weights, int bins)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < bins; i++)
+    {
+        uint32_t diff = current[i] > previous[i] ? current[i] - previous[i] : 0;
+        sum += (uint64_t)((diff >> 1) * (uint32_t)weights[i]);
+        previous[i] = current[i];
+    }
+    return (uint32_t)(sum >> 14);
+}
+
+#if defined(SPECTRALFLUX_ARM_DSP)
+
+// same style as the audio library's dspinst.h
+static inline uint32_t unsigned_saturating_subtract_16x2(uint32_t a, uint32_t b) __attribute__((always_inline, unused));
+static inline uint32_t unsigned_saturating_subtract_16x2(uint32_t a, uint32_t b)
+{
+    uint32_t out;
+    asm volatile("uqsub16 %0, %1, %2" : "=r"(out) : "r"(a), "r"(b));
+    return out;
+}
+
+static inline uint64_t multiply_accumulate_16x2_64(uint64_t sum, uint32_t a, uint32_t b) __attribute__((always_inline, unused));
+static inline uint64_t multiply_accumulate_16x2_64(uint64_t sum, uint32_t a, uint32_t b)
+{
+    asm volatile("smlald %Q0, %R0, %1, %2" : "+r"(sum) : "r"(a), "r"(b));
+    return sum;
+}
+
+uint32_t spectralFlux(const uint16_t *current, uint16_t *previous, const int16_t *weights, int bins)
+{
+    const uint32_t *cur = (const uint32_t *)current;
+    uint32_t *prev = (uint32_t *)previous;
+    const uint32_t *w = (const uint32_t *)weights;
+    uint64_t sum = 0;
+    for (int i = 0; i < bins / 2; i += 4)
+    {
+        uint32_t c0 = cur[i], c1 = cur[i + 1], c2 = cur[i + 2], c3 = cur[i + 3];
+        uint32_t d0 = (unsigned_saturating_subtract_16x2(c0, prev[i]) >> 1) & 0x7FFF7FFF;
+        uint32_t d1 = (unsigned_saturating_subtract_16x2(c1, prev[i + 1]) >> 1) & 0x7FFF7FFF;
+        uint32_t d2 = (unsigned_saturating_subtract_16x2(c2, prev[i + 2]) >> 1) & 0x7FFF7FFF;
+        uint32_t d3 = (unsigned_saturating_subtract_16x2(c3, prev[i + 3]) >> 1) & 0x7FFF7FFF;
+        sum = multiply_accumulate_16x2_64(sum, d0, w[i]);
+        sum = multiply_accumulate_16x2_64(sum, d1, w[i + 1]);
+        sum = multiply_accumulate_16x2_64(sum, d2, w[i + 2]);
+        sum = multiply_accumulate_16x2_64(sum, d3, w[i + 3]);
+        prev[i] = c0;
+        prev[i + 1] = c1;
+        prev[i + 2] = c2;
+        prev[i + 3] = c3;
+    }
+    return (uint32_t)(sum >> 14);
+}
+
+#elif defined(SPECTRALFLUX_SSE2)
+
+uint32_t spectralFlux(const uint16_t *current, uint16_t *previous, const int16_t *weights, int bins)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = zero; // two 64 bit lanes
+    for (int i = 0; i < bins; i += 8)
+    {
+        __m128i c = _mm_loadu_si128((const __m128i *)(current + i));
+        __m128i p = _mm_loadu_si128((const __m128i *)(previous + i));
+        __m128i w = _mm_loadu_si128((const __m128i *)(weights + i));
+        __m128i d = _mm_srli_epi16(_mm_subs_epu16(c, p), 1);
+        __m128i products = _mm_madd_epi16(d, w); // 4 x 32 bit, never negative
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(products, zero));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(products, zero));
+        _mm_storeu_si128((__m128i *)(previous + i), c);
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, sum);
+    return (uint32_t)((lanes[0] + lanes[1]) >> 14);
+}
+
+#elif defined(SPECTRALFLUX_NEON)
+
+uint32_t spectralFlux(const uint16_t *current, uint16_t *previous, const int16_t *weights, int bins)
+{
+    uint64x2_t sum = vdupq_n_u64(0);
+    for (int i = 0; i < bins; i += 8)
+    {
+        uint16x8_t c = vld1q_u16(current + i);
+        uint16x8_t d = vshrq_n_u16(vqsubq_u16(c, vld1q_u16(previous + i)), 1);
+        uint16x8_t w = vreinterpretq_u16_s16(vld1q_s16(weights + i));
+        sum = vpadalq_u32(sum, vmull_u16(vget_low_u16(d), vget_low_u16(w)));
+        sum = vpadalq_u32(sum, vmull_u16(vget_high_u16(d), vget_high_u16(w)));
+        vst1q_u16(previous + i, c);
+    }
+    return (uint32_t)((vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1)) >> 14);
+}
+
+#else
+
+uint32_t spectralFlux(const uint16_t *current, uint16_t *previous, const int16_t *weights, int bins)
+{
+    return spectralFluxScalar(current, previous, weights, bins);
+}
+
+#endif
@@ -0,0 +1,32 @@
+/*
+ * Spectral flux kernel for onset detection.
+ *
+ * For every fft bin the magnitude increase since the previous frame is taken
+ * (decreases count as 0), weighted and summed:
+ *
+ *     flux = sum over bins of weight[i] * max(current[i] - previous[i], 0)
+ *
+ * Magnitudes are the raw uint16_t values of AudioAnalyzeFFT256::output[], weights
+ * are Q15 (32767 = 1.0, must not be negative). The positive difference is halved
+ * before the multiply so it fits a signed 16 bit lane, and the result is shifted so
+ * a weight of 1.0 gives the plain sum of differences. Every implementation below does
+ * exactly this arithmetic so they all return the same value:
+ *   - Cortex-M7 (Teensy 4): UQSUB16 + SMLALD, two bins per instruction
+ *   - SSE2 (host x86): eight bins per instruction
+ *   - NEON (host arm): eight bins per instruction
+ *   - plain C everywhere else
+ */
+
+#ifndef SPECTRALFLUX_H
+#define SPECTRALFLUX_H
+
+#include <stdint.h>
+
+// bins must be a multiple of 8 and all three arrays 4 byte aligned (the Cortex-M7
+// version reads them as pairs of bins). previous is updated to current on return.
+uint32_t spectralFlux(const uint16_t *current, uint16_t *previous, const int16_t *weights, int bins);
+
+// portable version, same result. used as reference by the host benchmark.
+uint32_t spectralFluxScalar(const uint16_t *current, uint16_t *previous, const int16_t *weights, int bins);
+
+#endif // SPECTRALFLUX_H
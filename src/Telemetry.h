@@ -0,0 +1,87 @@
+/*
+ * Fixed size ring of beat detection telemetry records (TelemetryFormat.h).
+ *
+ * The detector writes into it every fft frame with push(), which is a struct copy and
+ * an index increment, so watching the detector doesn't change its timing the way five
+ * Serial.print float conversions per frame did. drain() is called from the main loop
+ * when there is time and only sends what the port can take without blocking.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <string.h>
+#include "TelemetryFormat.h"
+
+class Telemetry
+{
+public:
+    static const int SIZE = 128;        // records, about 0.3 s of 4 records per fft frame
+    static const int PACKET_RECORDS = 8; // records per packet, 202 bytes
+
+    void push(const TelemetryRecord &record)
+    {
+        if (count == SIZE)
+        {
+            dropped++;
+            return;
+        }
+        records[(head + count) % SIZE] = record;
+        count++;
+    }
+
+    // sends complete packets while the port has room for one, returns the number of records sent.
+    // Port is Serial on the teensy, anything with write(buffer, size) and availableForWrite() works
+    template <class Port>
+    int drain(Port &port)
+    {
+        int sent = 0;
+        while (count)
+        {
+            int n = count < PACKET_RECORDS ? count : PACKET_RECORDS;
+            if (port.availableForWrite() < (int)(sizeof(TelemetryPacketHeader) + n * sizeof(TelemetryRecord) + 2))
+            {
+                break;
+            }
+
+            uint8_t packet[sizeof(TelemetryPacketHeader) + PACKET_RECORDS * sizeof(TelemetryRecord) + 2];
+            TelemetryPacketHeader header = {{TELEMETRY_SYNC0, TELEMETRY_SYNC1}, TELEMETRY_VERSION, (uint8_t)n, dropped, 0};
+            memcpy(packet, &header, sizeof(header));
+            int size = sizeof(header);
+            for (int i = 0; i < n; i++)
+            {
+                memcpy(packet + size, &records[head], sizeof(TelemetryRecord));
+                size += sizeof(TelemetryRecord);
+                head = (head + 1) % SIZE;
+            }
+            count -= n;
+            dropped = 0;
+
+            uint16_t checksum = fletcher16(packet, size);
+            memcpy(packet + size, &checksum, 2);
+            size += 2;
+            port.write(packet, size);
+            sent += n;
+        }
+        return sent;
+    }
+
+    static uint16_t fletcher16(const uint8_t *data, int size)
+    {
+        uint16_t sum1 = 0, sum2 = 0;
+        for (int i = 0; i < size; i++)
+        {
+            sum1 = (sum1 + data[i]) % 255;
+            sum2 = (sum2 + sum1) % 255;
+        }
+        return (sum2 << 8) | sum1;
+    }
+
+private:
+    TelemetryRecord records[SIZE];
+    int head = 0; // oldest record
+    int count = 0;
+    uint16_t dropped = 0;
+};
+
+#endif // TELEMETRY_H
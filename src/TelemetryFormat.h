@@ -0,0 +1,56 @@
+/*
+ * Beat detection telemetry packets, sent over Serial by Telemetry (Telemetry.h) and
+ * read back by tools/telemetry.py.
+ *
+ * One TelemetryRecord per band per fft frame: the same average / max / threshold / value /
+ * retrigger the arduino serial plotter used to get as text, but binary and timestamped.
+ * Records are sent in packets:
+ *
+ *   TelemetryPacketHeader
+ *   TelemetryRecord[count]
+ *   uint16_t checksum       fletcher16 over header and records
+ *
+ * The sync bytes let the reader find the next packet after garbage or a lost byte,
+ * the checksum tells it the packet it found is real. Little endian like the teensy.
+ */
+
+#ifndef TELEMETRYFORMAT_H
+#define TELEMETRYFORMAT_H
+
+#include <stdint.h>
+
+#define TELEMETRY_SYNC0 0xA5
+#define TELEMETRY_SYNC1 0x5A
+#define TELEMETRY_VERSION 1
+
+#define TELEMETRY_ONSET 0xFF // band number of the spectral flux onset detector, bands are their BEAT_BANDS index
+
+// record flags
+#define TELEMETRY_READY 0x01 // retrigger time is over, a beat could be detected
+#define TELEMETRY_BEAT 0x02  // this frame was a beat
+
+struct TelemetryRecord
+{
+    uint32_t micros;  // when the fft frame was processed
+    uint8_t band;     // BEAT_BANDS index or TELEMETRY_ONSET
+    uint8_t flags;    // TELEMETRY_ flags
+    uint16_t frame;   // fft frame counter, wraps. gaps mean records were dropped
+    float average;    // all in fft256_1->read() units
+    float maxValue;
+    float threshold;
+    float value;
+};
+
+struct TelemetryPacketHeader
+{
+    uint8_t sync[2];  // TELEMETRY_SYNC0, TELEMETRY_SYNC1
+    uint8_t version;  // TELEMETRY_VERSION
+    uint8_t count;    // records in this packet
+    uint16_t dropped; // records lost because the ring was full since the last packet
+    uint16_t reserved;
+};
+
+static_assert(sizeof(TelemetryRecord) == 24, "TelemetryRecord must be packed");
+static_assert(sizeof(TelemetryPacketHeader) == 8, "TelemetryPacketHeader must be packed");
+
+#endif // TELEMETRYFORMAT_H
@@ -0,0 +1,92 @@
+/*
+ * Musical time for the cue tables: cues at bar, beat and tick instead of at a time.
+ *
+ * A tempo map says where bar 1 starts in the song, the tempo and how many beats a bar
+ * has, with another section wherever those change. The _BAR cue macros turn a bar, beat
+ * and tick into ms through it at compile time, so the tables still hold plain ms and
+ * CuePlayer can't tell the difference: it costs nothing while the show runs. Moving a
+ * show onto another edit of its song, or fixing its tempo, is one number in the map.
+ *
+ *   constexpr TempoSection songTempo[] = {
+ *     TEMPO_START(00.120, 103, 4), // bar 1 at 0.120 s, 103 bpm, 4 beats to the bar
+ *     TEMPO_CHANGE(33, 98, 4),     // 98 bpm from bar 33 on
+ *   };
+ *   static_assert(tempoMapValid(songTempo), "songTempo: bars out of order");
+ *
+ *   constexpr Cue song[] = {
+ *     FROM_BAR(songTempo, 9, 1, 0, CUE_QUARTERS, CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black),
+ *     FROM_BAR(songTempo, 9, 2, 0, CUE_QUARTERS, CRGB::Red, CRGB::Green, CRGB::Black, CRGB::Black),
+ *     AT_BAR(songTempo, 9, 2, 240, CUE_FILL, CRGB::White), // half a beat later
+ *   };
+ *
+ * Bars and beats count from 1, ticks from 0 with TICKS_PER_BEAT to the beat like MIDI.
+ * stayinAlive in Shows.cpp is a show on a tempo map.
+ * tools/showc.py reads the same in .cues files ("tempo" lines and bar.beat.tick times).
+ */
+
+#ifndef TEMPOMAP_H
+#define TEMPOMAP_H
+
+#include "Cue.h"
+
+#define TICKS_PER_BEAT 480
+
+struct TempoSection
+{
+    uint16_t bar;         // first bar of the section, 1 for the first
+    uint8_t beatsPerBar;
+    float bpm;
+    uint32_t startMillis; // where bar 1 is in the song, only in the first section
+};
+
+#define TEMPO_START(SECONDS, BPM, BEATS_PER_BAR) \
+  TempoSection { 1, BEATS_PER_BAR, BPM, TC(0, 0, SECONDS) }
+#define TEMPO_CHANGE(BAR, BPM, BEATS_PER_BAR) \
+  TempoSection { BAR, BEATS_PER_BAR, BPM, 0 }
+
+#define AT_BAR(MAP, BAR, BEAT, TICK, ACTION, ...) \
+  Cue { barMillis(MAP, BAR, BEAT, TICK), CUE_AT, ACTION, TRANSITION_CUT, 0, { __VA_ARGS__ } }
+#define FROM_BAR(MAP, BAR, BEAT, TICK, ACTION, ...) \
+  Cue { barMillis(MAP, BAR, BEAT, TICK), CUE_FROM, ACTION, TRANSITION_CUT, 0, { __VA_ARGS__ } }
+#define FROM_BAR_BLEND(MAP, BAR, BEAT, TICK, TRANSITION, LENGTH, ACTION, ...) \
+  Cue { barMillis(MAP, BAR, BEAT, TICK), CUE_FROM, ACTION, TRANSITION, LENGTH, { __VA_ARGS__ } }
+
+// song time of section i's first bar, ms
+template <size_t N>
+constexpr double sectionStartMillis(const TempoSection (&map)[N], size_t i)
+{
+    return i == 0 ? map[0].startMillis
+                  : sectionStartMillis(map, i - 1) + (map[i].bar - map[i - 1].bar) * map[i - 1].beatsPerBar * 60000.0 / map[i - 1].bpm;
+}
+
+// the section bar is in
+template <size_t N>
+constexpr size_t sectionOf(const TempoSection (&map)[N], uint16_t bar, size_t i = N - 1)
+{
+    return i == 0 || map[i].bar <= bar ? i : sectionOf(map, bar, i - 1);
+}
+
+template <size_t N>
+constexpr uint32_t barMillis(const TempoSection (&map)[N], uint16_t bar, uint16_t beat, uint16_t tick, size_t section)
+{
+    return (uint32_t)(sectionStartMillis(map, section) +
+                      ((bar - map[section].bar) * map[section].beatsPerBar + (beat - 1) + tick / (double)TICKS_PER_BEAT) * 60000.0 / map[section].bpm +
+                      0.5);
+}
+
+// ms into the song of bar, beat and tick
+template <size_t N>
+constexpr uint32_t barMillis(const TempoSection (&map)[N], uint16_t bar, uint16_t beat, uint16_t tick)
+{
+    return barMillis(map, bar, beat, tick, sectionOf(map, bar));
+}
+
+// starts at bar 1, bars go up, tempos and bars have a size
+template <size_t N>
+constexpr bool tempoMapValid(const TempoSection (&map)[N], size_t i = 0)
+{
+    return i >= N || ((i == 0 ? map[0].bar == 1 : map[i].bar > map[i - 1].bar) && map[i].bpm > 0 && map[i].beatsPerBar > 0 &&
+                      tempoMapValid(map, i + 1));
+}
+
+#endif // TEMPOMAP_H
@@ -0,0 +1,85 @@
+#include "TempoTracker.h"
+
+#include <math.h>
+
+TempoTracker::TempoTracker(float frameRate)
+    : frameRate(frameRate)
+{
+    minLag = (int)(60 * frameRate / MAX_BPM);
+    maxLag = (int)(60 * frameRate / MIN_BPM + 1);
+    if (2 * maxLag + 3 > MAX_LAG)
+    {
+        maxLag = (MAX_LAG - 3) / 2; // needs acf up to 2 * (maxLag + 1) + 1 for the comb and the parabola
+    }
+    decay = 1 - 1 / (HISTORY_SECONDS * frameRate);
+
+    float preferredLag = 60 * frameRate / PREFERRED_BPM;
+    for (int lag = 1; lag < MAX_LAG / 2; lag++)
+    {
+        float octaves = log2f(lag / preferredLag);
+        prior[lag] = expf(-0.5f * octaves * octaves);
+    }
+}
+
+// a period rarely is a whole number of frames, its peak is spread over neighbouring lags
+// so each tooth of the comb also takes half of its neighbours
+float TempoTracker::combScore(int lag)
+{
+    float beat = acf[lag] + 0.5f * (acf[lag - 1] + acf[lag + 1]);
+    float twoBeats = acf[2 * lag] + 0.5f * (acf[2 * lag - 1] + acf[2 * lag + 1]);
+    return (beat + twoBeats) * prior[lag];
+}
+
+void TempoTracker::update(float onset)
+{
+    mean = mean * decay + onset * (1 - decay);
+    float x = onset - mean;
+
+    head = (head + 1) & (HISTORY - 1);
+    history[head] = x;
+
+    // sliding autocorrelation, one multiply-add per lag
+    acf[0] = acf[0] * decay + x * x;
+    for (int lag = minLag - 2; lag <= 2 * maxLag + 3; lag++)
+    {
+        acf[lag] = acf[lag] * decay + x * history[(head - lag) & (HISTORY - 1)];
+    }
+
+    // comb: a real beat period also correlates at twice the period
+    int best = 0;
+    float bestScore = 0;
+    for (int lag = minLag; lag <= maxLag; lag++)
+    {
+        float score = combScore(lag);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = lag;
+        }
+    }
+
+    if (best == 0 || acf[0] <= 0)
+    {
+        confidence = 0;
+        return;
+    }
+
+    // parabola through the peak and its neighbours for a fractional lag
+    float left = combScore(best - 1);
+    float right = combScore(best + 1);
+    float curve = left - 2 * bestScore + right;
+    float offset = curve < 0 ? 0.5f * (left - right) / curve : 0;
+
+    period = best + offset;
+    tempo = 60 * frameRate / period;
+
+    confidence = acf[best] / acf[0];
+    if (confidence < 0)
+    {
+        confidence = 0;
+    }
+    if (confidence > 1)
+    {
+        confidence = 1;
+    }
+}
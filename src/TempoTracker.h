@@ -0,0 +1,59 @@
+/*
+ * Tempo estimation from the onset envelope, one update per fft frame.
+ *
+ * The envelope (how much "new sound" each fft frame has, see BeatDetector) is kept
+ * in a short history and autocorrelated incrementally: every frame each lag's
+ * correlation is decayed a little and the product of the newest value with the value
+ * lag frames ago is added. That gives a sliding, exponentially weighted autocorrelation
+ * over roughly the last HISTORY_SECONDS without ever recomputing it from scratch.
+ *
+ * A beat period shows up as a peak at its lag and at twice its lag (a comb), so the
+ * lag with the best acf[lag] + acf[2 * lag] wins. Bars and half bars correlate too, so
+ * the score is weighted with a broad preference for tempos around PREFERRED_BPM
+ * (log-gaussian, one octave wide), otherwise a strong backbeat easily reads as
+ * half tempo. Sub-frame precision comes from
+ * fitting a parabola through the winning lag and its neighbours.
+ *
+ * tempo is continuous and always has a value once music played,
+ * confidence (0..1) tells how much the peak stands out from the signal energy.
+ */
+
+#ifndef TEMPOTRACKER_H
+#define TEMPOTRACKER_H
+
+#include <stdint.h>
+
+class TempoTracker
+{
+public:
+    TempoTracker(float frameRate); // fft frames per second
+    void update(float onset);      // call once per fft frame with the onset envelope value
+
+    float tempo = 0;      // beats per minute, 0 until something periodic was heard
+    float confidence = 0; // 0 = noise, 1 = perfectly periodic
+    float period = 0;     // beat period in fft frames (fractional)
+
+    const float MIN_BPM = 60;
+    const float MAX_BPM = 200;
+    const float PREFERRED_BPM = 120;
+    const float HISTORY_SECONDS = 4; // time constant of the autocorrelation
+
+    static const int MAX_LAG = 240; // longest lag kept: 2 x the period of MIN_BPM at 115 frames/s
+    static const int HISTORY = 256; // power of two >= MAX_LAG + 1
+
+private:
+    float combScore(int lag);
+
+    float frameRate;
+    int minLag; // lag of MAX_BPM in frames
+    int maxLag; // lag of MIN_BPM in frames
+    float decay;
+
+    float mean = 0;              // slow average of the envelope, removed before correlating
+    float history[HISTORY] = {}; // envelope minus mean, ring buffer
+    unsigned int head = 0;       // index of the newest value in history
+    float acf[MAX_LAG + 1] = {}; // acf[0] is the signal energy
+    float prior[MAX_LAG / 2];    // tempo preference per lag
+};
+
+#endif // TEMPOTRACKER_H
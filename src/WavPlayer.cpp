@@ -0,0 +1,312 @@
+#include "WavPlayer.h"
+
+bool WavPlayer::play(const char *filename, uint32_t startMillis)
+{
+    stop();
+
+    // the playing song's track, the other one may hold a preloaded song
+    if (!open(*track, filename))
+    {
+        return false;
+    }
+    framesPlayed = 0;
+    playing = true; // seek() only works while playing
+    if (!seek(startMillis))
+    {
+        stop();
+        return false;
+    }
+    startMicros = micros();
+    return true;
+}
+
+void WavPlayer::stop()
+{
+    AudioNoInterrupts();
+    if (playing)
+    {
+        playing = false;
+        track->file.close();
+    }
+    AudioInterrupts();
+}
+
+bool WavPlayer::open(Track &song, const char *filename)
+{
+    song.preloadedFrames = 0;
+    song.file = SD.open(filename);
+    if (!song.file)
+    {
+        return false;
+    }
+    if (!readHeader(song))
+    {
+        Serial.print(filename);
+        Serial.println(" is not a 16 bit 44.1 kHz wav");
+        song.file.close();
+        return false;
+    }
+    return true;
+}
+
+bool WavPlayer::preload(const char *filename, bool follow)
+{
+    cancelPreload();
+
+    // the sd card is shared with update(), which reads the playing song in the audio interrupt
+    Track &next = idleTrack();
+    AudioNoInterrupts();
+    bool ok = open(next, filename);
+    AudioInterrupts();
+    if (!ok)
+    {
+        return false;
+    }
+    uint32_t frames = next.totalFrames < PRELOAD_FRAMES ? next.totalFrames : PRELOAD_FRAMES;
+    while (next.preloadedFrames < frames)
+    {
+        // a block at a time, so the audio interrupt is never held off for long
+        uint32_t count = frames - next.preloadedFrames < AUDIO_BLOCK_SAMPLES ? frames - next.preloadedFrames : AUDIO_BLOCK_SAMPLES;
+        AudioNoInterrupts();
+        int bytes = next.file.read(next.preloaded + next.preloadedFrames * next.channels, count * 2 * next.channels);
+        AudioInterrupts();
+        if (bytes != (int)(count * 2 * next.channels))
+        {
+            next.file.close();
+            return false;
+        }
+        next.preloadedFrames += count;
+    }
+
+    AudioNoInterrupts();
+    queued = &next;
+    this->follow = follow;
+    AudioInterrupts();
+    return true;
+}
+
+void WavPlayer::cancelPreload()
+{
+    AudioNoInterrupts();
+    if (queued)
+    {
+        queued->file.close();
+        queued = nullptr;
+    }
+    AudioInterrupts();
+}
+
+bool WavPlayer::playPreloaded()
+{
+    AudioNoInterrupts();
+    bool ok = queued != nullptr;
+    if (ok)
+    {
+        startQueued();
+    }
+    AudioInterrupts();
+    return ok;
+}
+
+// with the audio interrupt off, or from update()
+void WavPlayer::startQueued()
+{
+    if (playing)
+    {
+        track->file.close();
+    }
+    track = queued;
+    queued = nullptr;
+    framesPlayed = 0;
+    blockMicros = micros();
+    startMicros = blockMicros;
+    playing = true;
+    preloadStarts++;
+}
+
+// RIFF header, fmt chunk, maybe other chunks, data chunk
+bool WavPlayer::readHeader(Track &song)
+{
+    char riff[12];
+    if (song.file.read(riff, sizeof(riff)) != sizeof(riff) || memcmp(riff, "RIFF", 4) || memcmp(riff + 8, "WAVE", 4))
+    {
+        return false;
+    }
+
+    bool haveFormat = false;
+    while (true)
+    {
+        struct
+        {
+            char id[4];
+            uint32_t size;
+        } chunk;
+        if (song.file.read(&chunk, sizeof(chunk)) != sizeof(chunk))
+        {
+            return false;
+        }
+
+        if (!memcmp(chunk.id, "fmt ", 4))
+        {
+            struct
+            {
+                uint16_t format;
+                uint16_t channels;
+                uint32_t sampleRate;
+                uint32_t byteRate;
+                uint16_t blockAlign;
+                uint16_t bitsPerSample;
+            } format;
+            if (chunk.size < sizeof(format) || song.file.read(&format, sizeof(format)) != sizeof(format))
+            {
+                return false;
+            }
+            if (format.format != 1 || format.bitsPerSample != 16 || format.channels < 1 || format.channels > 2 || format.sampleRate != 44100)
+            {
+                return false;
+            }
+            song.channels = format.channels;
+            song.sampleRate = format.sampleRate;
+            haveFormat = true;
+            chunk.size -= sizeof(format);
+        }
+        else if (!memcmp(chunk.id, "data", 4))
+        {
+            song.dataStart = song.file.position();
+            song.totalFrames = chunk.size / (2 * song.channels);
+            return haveFormat;
+        }
+
+        // skip the rest of the chunk, chunks are padded to even sizes
+        if (!song.file.seek(song.file.position() + chunk.size + (chunk.size & 1)))
+        {
+            return false;
+        }
+    }
+}
+
+bool WavPlayer::seek(uint32_t positionMillis)
+{
+    uint32_t frame = (uint64_t)positionMillis * track->sampleRate / 1000;
+    if (!playing || frame >= track->totalFrames)
+    {
+        return false;
+    }
+
+    // not while update() is reading the file. the preloaded frames stay, the file goes on after them
+    AudioNoInterrupts();
+    uint32_t fromFile = frame > track->preloadedFrames ? frame : track->preloadedFrames;
+    bool ok = track->file.seek(track->dataStart + fromFile * 2 * track->channels);
+    framesPlayed = frame;
+    blockMicros = micros();
+    AudioInterrupts();
+    return ok;
+}
+
+uint32_t WavPlayer::positionMillis()
+{
+    return framesToMillis(framesPlayed);
+}
+
+uint32_t WavPlayer::positionMicros()
+{
+    uint32_t frames, at;
+    do
+    {
+        frames = framesPlayed;
+        at = blockMicros;
+    } while (frames != framesPlayed); // an update() came in between
+
+    // the audio clock only ticks once per block (2.9 ms), in between it's the cpu clock.
+    // never more than a block though, in case the audio stalls
+    uint32_t since = micros() - at;
+    uint32_t blockTime = (uint64_t)AUDIO_BLOCK_SAMPLES * 1000000 / track->sampleRate;
+    if (since > blockTime)
+    {
+        since = blockTime;
+    }
+    return (uint64_t)frames * 1000000 / track->sampleRate + since;
+}
+
+uint32_t WavPlayer::lengthMillis()
+{
+    return framesToMillis(track->totalFrames);
+}
+
+// count frames from frame on into left and right, fewer at the end of the song
+int WavPlayer::readFrames(Track &song, uint32_t frame, int16_t *left, int16_t *right, int count)
+{
+    if (frame + count > song.totalFrames)
+    {
+        count = song.totalFrames - frame;
+    }
+    int16_t samples[AUDIO_BLOCK_SAMPLES * 2];
+    int got = 0;
+    if (frame < song.preloadedFrames)
+    {
+        got = song.preloadedFrames - frame < (uint32_t)count ? song.preloadedFrames - frame : count;
+        memcpy(samples, song.preloaded + frame * song.channels, got * 2 * song.channels);
+    }
+    if (got < count)
+    {
+        int bytes = song.file.read(samples + got * song.channels, (count - got) * 2 * song.channels);
+        got += bytes > 0 ? bytes / (2 * song.channels) : 0;
+    }
+
+    for (int i = 0; i < got; i++)
+    {
+        left[i] = samples[i * song.channels];
+        right[i] = samples[i * song.channels + song.channels - 1];
+    }
+    return got;
+}
+
+void WavPlayer::update()
+{
+    if (!playing)
+    {
+        return;
+    }
+
+    audio_block_t *left = allocate();
+    if (!left)
+    {
+        return;
+    }
+    audio_block_t *right = allocate();
+    if (!right)
+    {
+        release(left);
+        return;
+    }
+
+    int got = readFrames(*track, framesPlayed, left->data, right->data, AUDIO_BLOCK_SAMPLES);
+    framesPlayed += got;
+    if (got < AUDIO_BLOCK_SAMPLES)
+    {
+        // end of the song
+        if (queued && follow)
+        {
+            // the next one goes on in the same block
+            startQueued();
+            framesPlayed = readFrames(*track, 0, left->data + got, right->data + got, AUDIO_BLOCK_SAMPLES - got);
+            got += framesPlayed;
+        }
+        else
+        {
+            playing = false;
+            track->file.close();
+        }
+    }
+    for (int i = got; i < AUDIO_BLOCK_SAMPLES; i++)
+    {
+        left->data[i] = 0;
+        right->data[i] = 0;
+    }
+    blockMicros = micros();
+
+    transmit(left, 0);
+    transmit(right, 1);
+    release(left);
+    release(right);
+}
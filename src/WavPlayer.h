@@ -0,0 +1,82 @@
+/*
+ * Plays a wav from the sd card like AudioPlaySdWav, but can start anywhere in the song
+ * and jump around while it plays (seek()), which AudioPlaySdWav can't.
+ *
+ * Only what the songs on the card are: 16 bit PCM, mono or stereo, 44100 Hz. The header
+ * is read in play() instead of in the audio interrupt, so the song is ready when play()
+ * returns. The samples are read in update() like AudioPlaySdWav does, one block per
+ * audio interrupt.
+ *
+ * The next song can be opened while one plays (preload()): its header is read and its
+ * first PRELOAD_FRAMES are in RAM, so playPreloaded() starts it without touching the sd
+ * card. With follow set it takes over by itself at the end of the playing song, in the
+ * middle of the same audio block, so there is no gap between the two.
+ *
+ * Outputs are left (0) and right (1), a mono wav goes out on both.
+ */
+
+#ifndef WAVPLAYER_H
+#define WAVPLAYER_H
+
+#include <Audio.h>
+#include <SD.h>
+
+class WavPlayer : public AudioStream
+{
+public:
+    WavPlayer() : AudioStream(0, nullptr) {}
+
+    bool play(const char *filename, uint32_t startMillis = 0); // false if it isn't a wav this can play
+    void stop();
+    bool isPlaying() { return playing; }
+
+    bool seek(uint32_t positionMillis); // false past the end of the song
+    uint32_t positionMillis();          // of the next block that goes out
+    uint32_t positionMicros();          // same, moving on with micros() between audio blocks
+    uint32_t lengthMillis();
+
+    // opens the song to play next, from its start. follow: it starts when the playing one ends
+    bool preload(const char *filename, bool follow);
+    void cancelPreload();
+    bool isPreloaded() { return queued != nullptr; }
+    bool playPreloaded(); // starts the preloaded song now, false if there is none
+
+    // counts up every time a preloaded song starts, by playPreloaded() or following the song before
+    uint16_t preloadsStarted() { return preloadStarts; }
+    uint32_t startedMicros() { return startMicros; } // micros() when the playing song started
+
+    void update() override;
+
+    static const int PRELOAD_FRAMES = 8 * AUDIO_BLOCK_SAMPLES; // 23 ms
+
+private:
+    struct Track
+    {
+        File file;
+        uint32_t dataStart = 0; // file offset of the first sample
+        uint32_t totalFrames = 0;
+        uint32_t sampleRate = 44100;
+        uint8_t channels = 2;
+        int16_t preloaded[PRELOAD_FRAMES * 2]; // the first frames, read by preload()
+        uint32_t preloadedFrames = 0;
+    };
+
+    bool open(Track &song, const char *filename);
+    bool readHeader(Track &song);
+    int readFrames(Track &song, uint32_t frame, int16_t *left, int16_t *right, int count);
+    void startQueued();
+    Track &idleTrack() { return track == &tracks[0] ? tracks[1] : tracks[0]; }
+    uint32_t framesToMillis(uint32_t frames) { return (uint64_t)frames * 1000 / track->sampleRate; }
+
+    Track tracks[2];
+    Track *volatile track = &tracks[0]; // playing, or last played
+    Track *volatile queued = nullptr;   // preloaded, in the other one
+    volatile bool follow = false;
+    volatile bool playing = false;
+    volatile uint32_t framesPlayed = 0;
+    volatile uint32_t blockMicros = 0; // micros() when framesPlayed last changed
+    volatile uint16_t preloadStarts = 0;
+    volatile uint32_t startMicros = 0;
+};
+
+#endif // WAVPLAYER_H
@@ -0,0 +1,104 @@
+/*
+ * Host stand-in for the bits of the Teensy core the beat detector uses.
+ * Only built in the [env:native] PlatformIO environment.
+ *
+ * Time does not run on its own here. The replay harness moves the clock forward
+ * as it feeds audio samples, so millis()/micros()/elapsedMillis see "audio time"
+ * and a whole song can be processed as fast as the CPU allows.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define LOW 0
+#define HIGH 1
+
+#define PROGMEM // tables in flash on the teensy, LedGeometry.h
+
+uint32_t millis();
+uint32_t micros();
+
+namespace host
+{
+    void setMicros(uint64_t us); // the harness owns the clock
+}
+
+class elapsedMillis
+{
+private:
+    uint32_t ms;
+
+public:
+    elapsedMillis(void) { ms = millis(); }
+    elapsedMillis(uint32_t val) { ms = millis() - val; }
+    elapsedMillis(const elapsedMillis &orig) { ms = orig.ms; }
+    operator uint32_t() const { return millis() - ms; }
+    elapsedMillis &operator=(const elapsedMillis &rhs)
+    {
+        ms = rhs.ms;
+        return *this;
+    }
+    elapsedMillis &operator=(uint32_t val)
+    {
+        ms = millis() - val;
+        return *this;
+    }
+};
+
+class elapsedMicros
+{
+private:
+    uint32_t us;
+
+public:
+    elapsedMicros(void) { us = micros(); }
+    elapsedMicros(uint32_t val) { us = micros() - val; }
+    elapsedMicros(const elapsedMicros &orig) { us = orig.us; }
+    operator uint32_t() const { return micros() - us; }
+    elapsedMicros &operator=(const elapsedMicros &rhs)
+    {
+        us = rhs.us;
+        return *this;
+    }
+    elapsedMicros &operator=(uint32_t val)
+    {
+        us = micros() - val;
+        return *this;
+    }
+};
+
+// Serial goes to stderr so the harness can keep stdout for its own report.
+class HostSerial
+{
+public:
+    void begin(uint32_t) {}
+    void print(const char *s) { fputs(s, stderr); }
+    void print(int v) { fprintf(stderr, "%d", v); }
+    void print(unsigned int v) { fprintf(stderr, "%u", v); }
+    void print(long v) { fprintf(stderr, "%ld", v); }
+    void print(unsigned long v) { fprintf(stderr, "%lu", v); }
+    void print(double v) { fprintf(stderr, "%.2f", v); }
+    template <typename T>
+    void println(T v)
+    {
+        print(v);
+        fputc('\n', stderr);
+    }
+    void println() { fputc('\n', stderr); }
+    // no binary on stderr: telemetry never finds room here, the harness drains it into a file instead
+    int availableForWrite() { return 0; }
+    size_t write(const uint8_t *buffer, size_t size) { return fwrite(buffer, 1, size, stderr); }
+};
+
+extern HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,108 @@
+/*
+ * Host stand-in for the Teensy audio library, only what BeatDetector and WavPlayer need.
+ * Only built in the native PlatformIO environments.
+ *
+ * AudioAnalyzeFFT256 mimics the teensy object as closely as is useful:
+ * 256 point FFT every 128 samples (50% overlap), Hanning window, magnitudes kept
+ * as uint16_t in output[] with the same scaling, and averageTogether() support.
+ * Instead of being fed by the audio interrupt, the harness calls update() with
+ * one block of mono samples at a time.
+ *
+ * There is no audio interrupt here. An AudioStream's update() is called by whoever runs
+ * it (test/test_wav_player), and the last block it transmitted on each output is kept
+ * for them in output().
+ */
+
+#ifndef HOST_AUDIO_H
+#define HOST_AUDIO_H
+
+#include "Arduino.h"
+
+#define AUDIO_BLOCK_SAMPLES 128
+#define AUDIO_SAMPLE_RATE_EXACT 44100.0f
+
+// there is no audio interrupt to hold off
+inline void AudioNoInterrupts() {}
+inline void AudioInterrupts() {}
+
+struct audio_block_t
+{
+    int16_t data[AUDIO_BLOCK_SAMPLES];
+};
+
+class AudioStream
+{
+public:
+    AudioStream(unsigned char, audio_block_t **) {}
+    virtual ~AudioStream() {}
+    virtual void update() = 0;
+
+    const int16_t *output(int index) const { return outputs[index]; }
+
+protected:
+    audio_block_t *allocate() { return new audio_block_t; }
+    void release(audio_block_t *block) { delete block; }
+    void transmit(audio_block_t *block, unsigned char index = 0) { memcpy(outputs[index], block->data, sizeof(block->data)); }
+
+private:
+    int16_t outputs[2][AUDIO_BLOCK_SAMPLES] = {};
+};
+
+class AudioAnalyzeFFT256
+{
+public:
+    AudioAnalyzeFFT256();
+    bool available()
+    {
+        if (outputflag)
+        {
+            outputflag = false;
+            return true;
+        }
+        return false;
+    }
+    float read(unsigned int binNumber)
+    {
+        if (binNumber > 127)
+            return 0.0;
+        return (float)(output[binNumber]) * (1.0 / 16384.0);
+    }
+    float read(unsigned int binFirst, unsigned int binLast)
+    {
+        if (binFirst > binLast)
+        {
+            unsigned int tmp = binLast;
+            binLast = binFirst;
+            binFirst = tmp;
+        }
+        if (binFirst > 127)
+            return 0.0;
+        if (binLast > 127)
+            binLast = 127;
+        uint32_t sum = 0;
+        do
+        {
+            sum += output[binFirst++];
+        } while (binFirst <= binLast);
+        return (float)sum * (1.0 / 16384.0);
+    }
+    void averageTogether(uint8_t n)
+    {
+        if (n == 0)
+            n = 1;
+        naverage = n;
+    }
+    void update(const int16_t *block); // one block of AUDIO_BLOCK_SAMPLES mono samples
+
+    uint16_t output[128] __attribute__((aligned(16)));
+
+private:
+    int16_t prevblock[AUDIO_BLOCK_SAMPLES];
+    bool havePrev = false;
+    uint32_t sum[128];
+    uint8_t count = 0;
+    uint8_t naverage = 1;
+    volatile bool outputflag = false;
+};
+
+#endif // HOST_AUDIO_H
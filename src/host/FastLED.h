@@ -0,0 +1,330 @@
+/*
+ * Host stand-in for the parts of FastLED the patterns use, for the show renderer.
+ * Only built in the [env:native_render] PlatformIO environment.
+ *
+ * The maths follow FastLED 3.5 (scale8 with FASTLED_SCALE8_FIXED, sin8/sin16,
+ * hsv2rgb_rainbow, ColorFromPalette, random8), so a render looks like the strip.
+ * Timing always goes through get_millisecond_timer(), like the teensy build with
+ * USE_GET_MILLISECOND_TIMER, so the renderer owns the clock.
+ */
+
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+#include <assert.h>
+
+#include "Arduino.h"
+
+typedef uint8_t fract8;
+
+uint32_t get_millisecond_timer();
+#define GET_MILLIS get_millisecond_timer
+
+// lib8tion
+
+inline uint8_t scale8(uint8_t i, uint8_t scale) { return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8; }
+inline uint8_t scale8_video(uint8_t i, uint8_t scale) { return (((uint16_t)i * scale) >> 8) + ((i && scale) ? 1 : 0); }
+inline uint16_t scale16(uint16_t i, uint16_t scale) { return ((uint32_t)i * (1 + (uint32_t)scale)) >> 16; }
+inline uint8_t qadd8(uint8_t i, uint8_t j)
+{
+    unsigned t = i + j;
+    return t > 255 ? 255 : t;
+}
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB)
+{
+    uint16_t partial = (a << 8) | b;
+    partial += b * amountOfB;
+    partial -= a * amountOfB;
+    return partial >> 8;
+}
+
+inline uint8_t sin8(uint8_t theta)
+{
+    static const uint8_t b_m16_interleave[] = {0, 49, 49, 41, 90, 27, 117, 10};
+    uint8_t offset = theta;
+    if (theta & 0x40)
+        offset = (uint8_t)255 - offset;
+    offset &= 0x3F;
+    uint8_t secoffset = offset & 0x0F;
+    if (theta & 0x40)
+        ++secoffset;
+    uint8_t section = offset >> 4;
+    uint8_t b = b_m16_interleave[section * 2];
+    uint8_t m16 = b_m16_interleave[section * 2 + 1];
+    uint8_t mx = (m16 * secoffset) >> 4;
+    int8_t y = mx + b;
+    if (theta & 0x80)
+        y = -y;
+    y += 128;
+    return y;
+}
+
+inline int16_t sin16(uint16_t theta)
+{
+    static const uint16_t base[] = {0, 6393, 12539, 18204, 23170, 27245, 30273, 32137};
+    static const uint8_t slope[] = {49, 48, 44, 38, 31, 23, 14, 4};
+    uint16_t offset = (theta & 0x3FFF) >> 3;
+    if (theta & 0x4000)
+        offset = 2047 - offset;
+    uint8_t section = offset / 256;
+    uint8_t secoffset8 = (uint8_t)(offset) / 2;
+    uint16_t mx = slope[section] * secoffset8;
+    int16_t y = mx + base[section];
+    if (theta & 0x8000)
+        y = -y;
+    return y;
+}
+
+inline uint16_t beat88(uint16_t beatsPerMinute88, uint32_t timebase = 0) { return ((GET_MILLIS() - timebase) * beatsPerMinute88 * 280) >> 16; }
+inline uint16_t beat16(uint16_t beatsPerMinute, uint32_t timebase = 0)
+{
+    if (beatsPerMinute < 256)
+        beatsPerMinute <<= 8;
+    return beat88(beatsPerMinute, timebase);
+}
+inline uint8_t beat8(uint16_t beatsPerMinute, uint32_t timebase = 0) { return beat16(beatsPerMinute, timebase) >> 8; }
+inline uint8_t beatsin8(uint16_t beatsPerMinute, uint8_t lowest = 0, uint8_t highest = 255, uint32_t timebase = 0, uint8_t phaseOffset = 0)
+{
+    uint8_t beatsin = sin8(beat8(beatsPerMinute, timebase) + phaseOffset);
+    return lowest + scale8(beatsin, highest - lowest);
+}
+inline uint16_t beatsin16(uint16_t beatsPerMinute, uint16_t lowest = 0, uint16_t highest = 65535, uint32_t timebase = 0, uint16_t phaseOffset = 0)
+{
+    uint16_t beatsin = sin16(beat16(beatsPerMinute, timebase) + phaseOffset) + 32768;
+    return lowest + scale16(beatsin, highest - lowest);
+}
+
+extern uint16_t rand16seed;
+inline uint8_t random8()
+{
+    rand16seed = rand16seed * 2053 + 13849;
+    return (uint8_t)(((uint8_t)(rand16seed & 0xFF)) + ((uint8_t)(rand16seed >> 8)));
+}
+inline uint8_t random8(uint8_t lim) { return (random8() * lim) >> 8; }
+inline uint8_t random8(uint8_t min, uint8_t lim) { return random8(lim - min) + min; }
+inline uint16_t random16()
+{
+    rand16seed = rand16seed * 2053 + 13849;
+    return rand16seed;
+}
+inline uint16_t random16(uint16_t lim) { return ((uint32_t)random16() * lim) >> 16; }
+inline void random16_set_seed(uint16_t seed) { rand16seed = seed; }
+
+// colours
+
+enum HSVHue
+{
+    HUE_RED = 0,
+    HUE_ORANGE = 32,
+    HUE_YELLOW = 64,
+    HUE_GREEN = 96,
+    HUE_AQUA = 128,
+    HUE_BLUE = 160,
+    HUE_PURPLE = 192,
+    HUE_PINK = 224
+};
+
+struct CHSV
+{
+    uint8_t hue, sat, val;
+    CHSV() {}
+    CHSV(uint8_t h, uint8_t s, uint8_t v) : hue(h), sat(s), val(v) {}
+};
+
+struct CRGB;
+void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb);
+
+struct CRGB
+{
+    union
+    {
+        struct
+        {
+            uint8_t r, g, b;
+        };
+        uint8_t raw[3];
+    };
+
+    // the ones the shows use, add more from FastLED's pixeltypes.h when needed
+    enum HTMLColorCode : uint32_t
+    {
+        Black = 0x000000,
+        Blue = 0x0000FF,
+        Green = 0x008000,
+        LawnGreen = 0x7CFC00,
+        LightBlue = 0xADD8E6,
+        Lime = 0x00FF00,
+        Orange = 0xFFA500,
+        Pink = 0xFFC0CB,
+        Purple = 0x800080,
+        Red = 0xFF0000,
+        Salmon = 0xFA8072,
+        White = 0xFFFFFF,
+        Yellow = 0xFFFF00,
+    };
+
+    CRGB() {}
+    CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+    CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) {}
+    CRGB(const CHSV &hsv) { hsv2rgb_rainbow(hsv, *this); }
+
+    uint8_t &operator[](uint8_t x) { return raw[x]; }
+
+    CRGB &operator+=(const CRGB &rhs)
+    {
+        r = qadd8(r, rhs.r);
+        g = qadd8(g, rhs.g);
+        b = qadd8(b, rhs.b);
+        return *this;
+    }
+    CRGB &operator|=(const CRGB &rhs)
+    {
+        if (rhs.r > r)
+            r = rhs.r;
+        if (rhs.g > g)
+            g = rhs.g;
+        if (rhs.b > b)
+            b = rhs.b;
+        return *this;
+    }
+    CRGB &nscale8(uint8_t scale)
+    {
+        r = scale8(r, scale);
+        g = scale8(g, scale);
+        b = scale8(b, scale);
+        return *this;
+    }
+    CRGB &fadeToBlackBy(uint8_t fadefactor) { return nscale8(255 - fadefactor); }
+};
+
+inline bool operator==(const CRGB &lhs, const CRGB &rhs) { return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b; }
+inline bool operator!=(const CRGB &lhs, const CRGB &rhs) { return !(lhs == rhs); }
+
+// a run of leds, ledset(first, last) hands out a pointer to first like CPixelView does
+class CRGBSet
+{
+public:
+    CRGBSet(CRGB *leds, int count) : leds(leds), count(count) {}
+    CRGB *operator()(int first, int last) const
+    {
+        assert(first <= last && last < count);
+        return leds + first;
+    }
+    operator CRGB *() const { return leds; }
+
+private:
+    CRGB *leds;
+    int count;
+};
+
+inline void fill_solid(CRGB *leds, int numToFill, const CRGB &color)
+{
+    for (int i = 0; i < numToFill; i++)
+        leds[i] = color;
+}
+inline void fill_rainbow(CRGB *leds, int numToFill, uint8_t initialhue, uint8_t deltahue = 5)
+{
+    CHSV hsv(initialhue, 240, 255);
+    for (int i = 0; i < numToFill; i++)
+    {
+        leds[i] = hsv;
+        hsv.hue += deltahue;
+    }
+}
+inline void fadeToBlackBy(CRGB *leds, uint16_t numLeds, uint8_t fadeBy)
+{
+    for (uint16_t i = 0; i < numLeds; i++)
+        leds[i].nscale8(255 - fadeBy);
+}
+inline CRGB *blend(const CRGB *src1, const CRGB *src2, CRGB *dest, uint16_t count, fract8 amountOfsrc2)
+{
+    for (uint16_t i = 0; i < count; i++)
+        dest[i] = CRGB(blend8(src1[i].r, src2[i].r, amountOfsrc2), blend8(src1[i].g, src2[i].g, amountOfsrc2), blend8(src1[i].b, src2[i].b, amountOfsrc2));
+    return dest;
+}
+
+// palettes
+
+enum TBlendType
+{
+    NOBLEND = 0,
+    LINEARBLEND = 1
+};
+
+typedef uint32_t TProgmemRGBPalette16[16];
+extern const TProgmemRGBPalette16 PartyColors_p;
+
+class CRGBPalette16
+{
+public:
+    CRGBPalette16(const TProgmemRGBPalette16 &rhs)
+    {
+        for (int i = 0; i < 16; i++)
+            entries[i] = CRGB(rhs[i]);
+    }
+    const CRGB &operator[](int x) const { return entries[x]; }
+
+private:
+    CRGB entries[16];
+};
+
+CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND);
+
+// EVERY_N_MILLISECONDS & co.
+
+class CEveryNMillis
+{
+public:
+    CEveryNMillis(uint32_t period) : period(period), previous(GET_MILLIS()) {}
+    void setPeriod(uint32_t newPeriod) { period = newPeriod; }
+    bool ready()
+    {
+        bool isReady = GET_MILLIS() - previous >= period;
+        if (isReady)
+            previous = GET_MILLIS();
+        return isReady;
+    }
+    operator bool() { return ready(); }
+
+private:
+    uint32_t period;
+    uint32_t previous;
+};
+
+#define FASTLED_CONCAT2(A, B) A##B
+#define FASTLED_CONCAT(A, B) FASTLED_CONCAT2(A, B)
+#define EVERY_N_MILLISECONDS(N) EVERY_N_MILLISECONDS_I(FASTLED_CONCAT(PER, __COUNTER__), N)
+#define EVERY_N_MILLISECONDS_I(NAME, N) \
+    static CEveryNMillis NAME(N);       \
+    if (NAME)
+#define EVERY_N_SECONDS(N) EVERY_N_MILLISECONDS((N) * 1000)
+
+// FastLED itself: brightness and the leds to clear, nothing is shown
+
+class CFastLED
+{
+public:
+    void addLeds(CRGB *data, int count)
+    {
+        leds = data;
+        numLeds = count;
+    }
+    void setBrightness(uint8_t scale) { brightness = scale; }
+    uint8_t getBrightness() { return brightness; }
+    void clear()
+    {
+        if (leds)
+            fill_solid(leds, numLeds, CRGB(0, 0, 0));
+    }
+    void show() {}
+
+private:
+    CRGB *leds = nullptr;
+    int numLeds = 0;
+    uint8_t brightness = 255;
+};
+
+extern CFastLED FastLED;
+
+#endif // HOST_FASTLED_H
@@ -0,0 +1,72 @@
+#include "FrameCacheWriter.h"
+
+static bool sameColor(const CRGB &a, const CRGB &b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+void encodeFrame(const CRGB *frame, const CRGB *previous, std::vector<uint8_t> &out)
+{
+    for (int i = 0; i < NUM_LEDS;)
+    {
+        int length = 1;
+        if (previous && sameColor(frame[i], previous[i]))
+        {
+            while (i + length < NUM_LEDS && length < FRAMECACHE_MAX_RUN && sameColor(frame[i + length], previous[i + length]))
+                length++;
+            out.push_back(FRAMECACHE_KEEP | (length - 1));
+        }
+        else if (i + 1 < NUM_LEDS && sameColor(frame[i + 1], frame[i]))
+        {
+            while (i + length < NUM_LEDS && length < FRAMECACHE_MAX_RUN && sameColor(frame[i + length], frame[i]))
+                length++;
+            out.push_back(FRAMECACHE_FILL | (length - 1));
+            out.insert(out.end(), frame[i].raw, frame[i].raw + 3);
+        }
+        else
+        {
+            // up to where a KEEP or FILL run would start
+            while (i + length < NUM_LEDS && length < FRAMECACHE_MAX_RUN &&
+                   !(previous && sameColor(frame[i + length], previous[i + length])) &&
+                   !(i + length + 1 < NUM_LEDS && sameColor(frame[i + length + 1], frame[i + length])))
+                length++;
+            out.push_back(FRAMECACHE_COPY | (length - 1));
+            out.insert(out.end(), (const uint8_t *)(frame + i), (const uint8_t *)(frame + i + length));
+        }
+        i += length;
+    }
+}
+
+void CacheWriter::add(uint32_t frame, const CRGB *leds)
+{
+    if (span.frameCount && frame != span.firstFrame + span.frameCount)
+        endSpan();
+    if (!span.frameCount)
+        span.firstFrame = frame;
+    encodeFrame(leds, span.frameCount ? previous : nullptr, spanFrames);
+    memcpy(previous, leds, sizeof(previous));
+    span.frameCount++;
+    frameCount++;
+}
+
+void CacheWriter::endSpan()
+{
+    if (!span.frameCount)
+        return;
+    span.dataSize = spanFrames.size();
+    const uint8_t *header = (const uint8_t *)&span;
+    data.insert(data.end(), header, header + sizeof(span));
+    data.insert(data.end(), spanFrames.begin(), spanFrames.end());
+    spanFrames.clear();
+    span.frameCount = 0;
+    spanCount++;
+}
+
+std::vector<uint8_t> CacheWriter::file(uint32_t framePeriodMicros, uint32_t showId)
+{
+    endSpan();
+    FrameCacheHeader header = {{'L', 'E', 'D', 'C'}, FRAMECACHE_VERSION, NUM_LEDS, framePeriodMicros, showId, spanCount};
+    std::vector<uint8_t> bytes((const uint8_t *)&header, (const uint8_t *)&header + sizeof(header));
+    bytes.insert(bytes.end(), data.begin(), data.end());
+    return bytes;
+}
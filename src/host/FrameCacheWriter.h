@@ -0,0 +1,35 @@
+/*
+ * Frame cache encoding for the host tools, the other half of FrameCache (FrameCacheFormat.h).
+ * render.cpp writes song.cache with it, test/test_frame_cache plays its output back.
+ */
+
+#ifndef HOST_FRAMECACHEWRITER_H
+#define HOST_FRAMECACHEWRITER_H
+
+#include <FastLED.h>
+#include <vector>
+#include "FrameCacheFormat.h"
+#include "LedLayout.h"
+
+// frame as runs against previous, nullptr for the first frame of a span
+void encodeFrame(const CRGB *frame, const CRGB *previous, std::vector<uint8_t> &out);
+
+// collects the cacheable frames of a render into spans
+struct CacheWriter
+{
+    std::vector<uint8_t> data; // all spans, headers and frames
+    std::vector<uint8_t> spanFrames;
+    FrameCacheSpan span = {0, 0, 0};
+    uint32_t spanCount = 0;
+    uint32_t frameCount = 0;
+    CRGB previous[NUM_LEDS];
+
+    // frame is its index on the frame grid, frames that don't follow the one before start a span
+    void add(uint32_t frame, const CRGB *leds);
+    void endSpan();
+
+    // the whole .cache file, after the last add()
+    std::vector<uint8_t> file(uint32_t framePeriodMicros, uint32_t showId);
+};
+
+#endif // HOST_FRAMECACHEWRITER_H
@@ -0,0 +1,97 @@
+#include "Audio.h"
+
+#include <complex>
+
+static uint64_t hostMicros = 0;
+
+uint32_t millis() { return (uint32_t)(hostMicros / 1000); }
+uint32_t micros() { return (uint32_t)hostMicros; }
+void host::setMicros(uint64_t us) { hostMicros = us; }
+
+HostSerial Serial;
+
+// Hanning window in Q15, same shape as AudioWindowHanning256
+static int16_t hanning256[256];
+
+AudioAnalyzeFFT256::AudioAnalyzeFFT256()
+{
+    if (hanning256[128] == 0)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            hanning256[i] = (int16_t)(32767.0 * 0.5 * (1.0 - cos(2.0 * M_PI * i / 256.0)));
+        }
+    }
+    memset(output, 0, sizeof(output));
+    memset(sum, 0, sizeof(sum));
+    memset(prevblock, 0, sizeof(prevblock));
+}
+
+// plain iterative radix 2 fft, n must be a power of two
+static void fft(std::complex<float> *x, int n)
+{
+    for (int i = 1, j = 0; i < n; i++)
+    {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(x[i], x[j]);
+    }
+    for (int len = 2; len <= n; len <<= 1)
+    {
+        float ang = -2.0f * (float)M_PI / len;
+        std::complex<float> wlen(cosf(ang), sinf(ang));
+        for (int i = 0; i < n; i += len)
+        {
+            std::complex<float> w(1.0f, 0.0f);
+            for (int j = 0; j < len / 2; j++)
+            {
+                std::complex<float> u = x[i + j];
+                std::complex<float> v = x[i + j + len / 2] * w;
+                x[i + j] = u + v;
+                x[i + j + len / 2] = u - v;
+                w *= wlen;
+            }
+        }
+    }
+}
+
+void AudioAnalyzeFFT256::update(const int16_t *block)
+{
+    if (!havePrev)
+    {
+        memcpy(prevblock, block, sizeof(prevblock));
+        havePrev = true;
+        return;
+    }
+
+    std::complex<float> buffer[256];
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+    {
+        buffer[i] = (float)((prevblock[i] * hanning256[i]) >> 15);
+        buffer[i + 128] = (float)((block[i] * hanning256[i + 128]) >> 15);
+    }
+    memcpy(prevblock, block, sizeof(prevblock));
+
+    fft(buffer, 256);
+
+    // arm_cfft_radix4_q15 scales its 256 point output down by 8 bits
+    for (int i = 0; i < 128; i++)
+    {
+        float mag = std::abs(buffer[i]) * (1.0f / 256.0f);
+        sum[i] += (uint32_t)(mag + 0.5f);
+    }
+    if (++count >= naverage)
+    {
+        for (int i = 0; i < 128; i++)
+        {
+            uint32_t v = sum[i] / naverage;
+            output[i] = v > 65535 ? 65535 : v;
+            sum[i] = 0;
+        }
+        count = 0;
+        outputflag = true;
+    }
+}
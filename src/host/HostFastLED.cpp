@@ -0,0 +1,138 @@
+#include "FastLED.h"
+
+CFastLED FastLED;
+uint16_t rand16seed = 1337;
+
+const TProgmemRGBPalette16 PartyColors_p = {
+    0x5500AB, 0x84007C, 0xB5004B, 0xE5001B,
+    0xE81700, 0xB84700, 0xAB7700, 0xABAB00,
+    0xAB5500, 0xDD2200, 0xF2000E, 0xC2003E,
+    0x8F0071, 0x5F00A1, 0x2F00D0, 0x0007F9};
+
+void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb)
+{
+    uint8_t hue = hsv.hue;
+    uint8_t sat = hsv.sat;
+    uint8_t val = hsv.val;
+
+    uint8_t offset8 = (hue & 0x1F) << 3; // position within the 1/8 of the wheel
+    uint8_t third = scale8(offset8, 256 / 3);
+    uint8_t twothirds = scale8(offset8, (256 * 2) / 3);
+
+    uint8_t r, g, b;
+    switch (hue >> 5)
+    {
+    case 0: // red -> orange
+        r = 255 - third;
+        g = third;
+        b = 0;
+        break;
+    case 1: // orange -> yellow
+        r = 171;
+        g = 85 + third;
+        b = 0;
+        break;
+    case 2: // yellow -> green
+        r = 171 - twothirds;
+        g = 170 + third;
+        b = 0;
+        break;
+    case 3: // green -> aqua
+        r = 0;
+        g = 255 - third;
+        b = third;
+        break;
+    case 4: // aqua -> blue
+        r = 0;
+        g = 171 - twothirds;
+        b = 85 + twothirds;
+        break;
+    case 5: // blue -> purple
+        r = third;
+        g = 0;
+        b = 255 - third;
+        break;
+    case 6: // purple -> pink
+        r = 85 + third;
+        g = 0;
+        b = 171 - third;
+        break;
+    default: // pink -> red
+        r = 170 + third;
+        g = 0;
+        b = 85 - third;
+        break;
+    }
+
+    if (sat != 255)
+    {
+        if (sat == 0)
+        {
+            r = g = b = 255;
+        }
+        else
+        {
+            uint8_t desat = 255 - sat;
+            desat = scale8_video(desat, desat);
+            uint8_t satscale = 255 - desat;
+            r = scale8(r, satscale) + desat;
+            g = scale8(g, satscale) + desat;
+            b = scale8(b, satscale) + desat;
+        }
+    }
+
+    if (val != 255)
+    {
+        val = scale8_video(val, val);
+        if (val == 0)
+        {
+            r = g = b = 0;
+        }
+        else
+        {
+            r = scale8(r, val);
+            g = scale8(g, val);
+            b = scale8(b, val);
+        }
+    }
+
+    rgb = CRGB(r, g, b);
+}
+
+CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index, uint8_t brightness, TBlendType blendType)
+{
+    uint8_t hi4 = index >> 4;
+    uint8_t lo4 = index & 0x0F;
+    CRGB color = pal[hi4];
+
+    if (lo4 && blendType != NOBLEND)
+    {
+        const CRGB &next = pal[hi4 == 15 ? 0 : hi4 + 1];
+        uint8_t f2 = lo4 << 4;
+        uint8_t f1 = 255 - f2;
+        for (int i = 0; i < 3; i++)
+        {
+            color.raw[i] = scale8(color.raw[i], f1) + scale8(next.raw[i], f2);
+        }
+    }
+
+    if (brightness != 255)
+    {
+        if (brightness)
+        {
+            brightness++; // adjust for rounding
+            for (int i = 0; i < 3; i++)
+            {
+                if (color.raw[i])
+                {
+                    color.raw[i] = scale8(color.raw[i], brightness);
+                }
+            }
+        }
+        else
+        {
+            color = CRGB(0, 0, 0);
+        }
+    }
+    return color;
+}
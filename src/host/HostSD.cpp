@@ -0,0 +1,9 @@
+#include "SD.h"
+
+SDClass SD;
+
+std::map<std::string, std::vector<uint8_t>> &host::sdFiles()
+{
+    static std::map<std::string, std::vector<uint8_t>> files;
+    return files;
+}
@@ -0,0 +1,76 @@
+/*
+ * Host stand-in for the Teensy SD library, only what WavPlayer and the sidecar readers
+ * (Sidecar.h) use. Only built in the native PlatformIO environments.
+ *
+ * The card is in memory: host::sdFiles() maps file names to their bytes, the tests in
+ * test/ put the songs, shows and caches there before they open them.
+ */
+
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include "Arduino.h"
+#include <map>
+#include <string>
+#include <vector>
+
+#define FILE_READ 0
+
+namespace host
+{
+    std::map<std::string, std::vector<uint8_t>> &sdFiles();
+}
+
+class File
+{
+public:
+    File() {}
+    File(const std::vector<uint8_t> *data) : data(data) {}
+
+    int read(void *buffer, size_t size)
+    {
+        if (!data)
+        {
+            return -1;
+        }
+        size_t count = at < data->size() ? data->size() - at : 0;
+        count = size < count ? size : count;
+        memcpy(buffer, data->data() + at, count);
+        at += count;
+        return (int)count;
+    }
+    bool seek(uint64_t position)
+    {
+        if (!data || position > data->size())
+        {
+            return false;
+        }
+        at = position;
+        return true;
+    }
+    uint64_t position() const { return at; }
+    uint64_t size() const { return data ? data->size() : 0; }
+    int available() const { return (int)(size() - at); }
+    void close() { data = nullptr; }
+    operator bool() const { return data != nullptr; }
+
+private:
+    const std::vector<uint8_t> *data = nullptr; // in host::sdFiles()
+    uint64_t at = 0;
+};
+
+class SDClass
+{
+public:
+    bool begin(uint8_t) { return true; }
+    bool exists(const char *name) { return host::sdFiles().count(name) > 0; }
+    File open(const char *name, uint8_t = FILE_READ)
+    {
+        auto file = host::sdFiles().find(name);
+        return file == host::sdFiles().end() ? File() : File(&file->second);
+    }
+};
+
+extern SDClass SD;
+
+#endif // HOST_SD_H
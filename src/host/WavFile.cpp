@@ -0,0 +1,83 @@
+#include "WavFile.h"
+
+#include <string.h>
+
+static uint32_t le32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+WavFile::~WavFile()
+{
+    if (file)
+        fclose(file);
+}
+
+bool WavFile::open(const char *path)
+{
+    file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    uint8_t riff[12];
+    if (fread(riff, 1, 12, file) != 12 || memcmp(riff, "RIFF", 4) || memcmp(riff + 8, "WAVE", 4))
+        return false;
+
+    // walk the chunks until we find "data", picking up "fmt " on the way
+    uint8_t hdr[8];
+    uint16_t bits = 0;
+    while (fread(hdr, 1, 8, file) == 8)
+    {
+        uint32_t len = le32(hdr + 4);
+        if (!memcmp(hdr, "fmt ", 4))
+        {
+            uint8_t fmt[16];
+            if (len < 16 || fread(fmt, 1, 16, file) != 16)
+                return false;
+            if (le16(fmt) != 1) // PCM only
+                return false;
+            channels = le16(fmt + 2);
+            sampleRate = le32(fmt + 4);
+            bits = le16(fmt + 14);
+            fseek(file, len - 16 + (len & 1), SEEK_CUR);
+        }
+        else if (!memcmp(hdr, "data", 4))
+        {
+            if (bits != 16 || channels < 1 || channels > 2)
+                return false;
+            dataStart = ftell(file);
+            totalSamples = len / (2 * channels);
+            samplesLeft = totalSamples;
+            return true;
+        }
+        else
+        {
+            fseek(file, len + (len & 1), SEEK_CUR);
+        }
+    }
+    return false;
+}
+
+size_t WavFile::readMono(int16_t *dst, size_t samples)
+{
+    if (samples > samplesLeft)
+        samples = samplesLeft;
+
+    int16_t frame[2];
+    size_t n = 0;
+    for (; n < samples; n++)
+    {
+        if (fread(frame, 2, channels, file) != channels)
+            break;
+        if (channels == 2)
+            dst[n] = (int16_t)(((int32_t)frame[0] + frame[1]) / 2);
+        else
+            dst[n] = frame[0];
+    }
+    samplesLeft -= n;
+    return n;
+}
+
+void WavFile::rewind()
+{
+    fseek(file, dataStart, SEEK_SET);
+    samplesLeft = totalSamples;
+}
@@ -0,0 +1,32 @@
+/*
+ * Minimal WAV reader for the host tools.
+ * Reads 16 bit PCM (mono or stereo) and hands out mono samples mixed the same
+ * way mixer1 does on the device (0.5 * left + 0.5 * right).
+ */
+
+#ifndef HOST_WAVFILE_H
+#define HOST_WAVFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+
+class WavFile
+{
+public:
+    ~WavFile();
+    bool open(const char *path);  // false if the file is missing or not 16 bit PCM
+    size_t readMono(int16_t *dst, size_t samples); // returns samples read, 0 at end of data
+    void rewind();
+
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+    uint32_t totalSamples = 0; // per channel
+
+private:
+    FILE *file = nullptr;
+    long dataStart = 0;
+    uint32_t samplesLeft = 0;
+};
+
+#endif // HOST_WAVFILE_H
@@ -0,0 +1,297 @@
+/*
+ * Offline show renderer.
+ *
+ * Runs a show through the same Shows.cpp/Patterns.cpp code as the teensy, frame by
+ * frame on the FRAMES_PER_SECOND grid of a simulated song clock, at full CPU speed
+ * and without any audio or led hardware. Every leds[] frame goes into a .frames
+ * file (FrameFileFormat.h), tools/frames.py turns that into a png strip or diffs two
+ * renders. It also writes the frame caches (FrameCacheFormat.h) the teensy plays the
+ * deterministic parts of a show from. Build and run with:
+ *   pio run -e native_render
+ *   .pio/build/native_render/program -o astro.frames astro.wav
+ *
+ * SHOW is one of the compiled in shows, by song file name (astro.wav) or number.
+ *
+ * options:
+ *   -o FILE   write the frames to FILE
+ *   -C FILE   write the cacheable frames to FILE, a frame cache for the sd card (song.cache)
+ *   -c FILE   play the cues of a .show file (tools/showc.py) instead of the compiled in ones
+ *   -k        with -c: only compare the file's cues with the compiled in SHOW's, exit 1 if they
+ *             differ. for a .cues kept in step with a table (shows/test2.cues), it checks
+ *             showc.py's bar_millis() against barMillis() in TempoMap.h
+ *   -a FILE   the song's wav: run the beat detector on it like the teensy does, so the
+ *             beat driven patterns have beats. without it there are none
+ *   -s TIME   start at TIME (seconds), the show is rebuilt there like a seek does
+ *   -e TIME   stop at TIME, default the end of the wav or 5 s after the last cue
+ *   -p        profile: time spent in each cue action per frame
+ *   -n COUNT  render COUNT times (for profilers), only the first is written
+ */
+
+#include <Audio.h>
+#include <chrono>
+#include <ctype.h>
+#include <new>
+#include <vector>
+
+#include "FrameCacheWriter.h"
+#include "FrameFileFormat.h"
+#include "Patterns.h"
+#include "ShowFileFormat.h"
+#include "Shows.h"
+#include "WavFile.h"
+
+AudioAnalyzeFFT256 fft256_1;
+BeatDetector beatDetector(fft256_1);
+
+// what -p reports, by CueAction
+static const char *actionNames[] = {
+    "brightness", "hue", "fill", "fade", "quarters", "bpm", "pulsing", "flash_pulsing",
+    "fill_gradual", "wiggle_lines", "applause", "juggle", "rainbow_glitter", "confetti", "fade_to_black"};
+static_assert(sizeof(actionNames) / sizeof(actionNames[0]) == CUE_FADE_TO_BLACK + 1, "actionNames is missing a CueAction");
+
+static double actionNanos[256];
+static uint32_t actionCalls[256];
+
+static void profiledCue(const Cue &cue)
+{
+    auto start = std::chrono::steady_clock::now();
+    runCue(cue);
+    actionNanos[cue.action] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    actionCalls[cue.action]++;
+}
+
+// a whole .show file in memory
+static bool loadShowFile(const char *path, std::vector<Cue> &cues)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    ShowFileHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && !memcmp(header.magic, SHOWFILE_MAGIC, 4) && header.version == SHOWFILE_VERSION;
+    if (ok)
+    {
+        cues.resize(header.cueCount);
+        ok = fread(cues.data(), sizeof(Cue), cues.size(), file) == cues.size();
+    }
+    fclose(file);
+    return ok;
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: program [-o FILE.frames] [-C FILE.cache] [-c FILE.show [-k]] [-a FILE.wav] [-s TIME] [-e TIME] [-p] [-n COUNT] SHOW\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *outPath = nullptr;
+    const char *cachePath = nullptr;
+    const char *showPath = nullptr;
+    const char *audioPath = nullptr;
+    const char *showName = nullptr;
+    uint32_t start = 0;
+    uint32_t end = 0;
+    bool profile = false;
+    bool check = false;
+    int repeats = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            outPath = argv[++i];
+        else if (!strcmp(argv[i], "-C") && i + 1 < argc)
+            cachePath = argv[++i];
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+            showPath = argv[++i];
+        else if (!strcmp(argv[i], "-a") && i + 1 < argc)
+            audioPath = argv[++i];
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            start = atof(argv[++i]) * 1000;
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc)
+            end = atof(argv[++i]) * 1000;
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            repeats = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-p"))
+            profile = true;
+        else if (!strcmp(argv[i], "-k"))
+            check = true;
+        else if (argv[i][0] == '-')
+            usage();
+        else
+            showName = argv[i];
+    }
+    if (!showName || repeats < 1 || (check && !showPath))
+        usage();
+
+    const Show *show = nullptr;
+    for (int i = 0; i < gNumberOfPatterns; i++)
+    {
+        if (!strcmp(gShows[i].filename, showName) || (isdigit(showName[0]) && atoi(showName) == i))
+            show = &gShows[i];
+    }
+    std::vector<Cue> cues;
+    if (showPath)
+    {
+        if (!loadShowFile(showPath, cues))
+        {
+            fprintf(stderr, "%s: not a show file\n", showPath);
+            return 1;
+        }
+    }
+    else if (show)
+    {
+        cues.assign(show->cues, show->cues + show->count);
+    }
+    else
+    {
+        fprintf(stderr, "%s: no such show, there are:\n", showName);
+        for (int i = 0; i < gNumberOfPatterns; i++)
+            fprintf(stderr, "%2d %s\n", i, gShows[i].filename);
+        return 1;
+    }
+    if (check)
+    {
+        if (!show)
+        {
+            fprintf(stderr, "%s: no such show\n", showName);
+            return 1;
+        }
+        for (size_t i = 0; i < cues.size() || i < show->count; i++)
+        {
+            if (i == cues.size() || i == show->count || memcmp(&cues[i], &show->cues[i], sizeof(Cue)))
+            {
+                uint32_t fileTime = i < cues.size() ? cues[i].time : 0, tableTime = i < show->count ? show->cues[i].time : 0;
+                printf("%s: cue %zu differs from %s: %u ms in the file, %u ms in the table\n", showPath, i + 1, show->filename,
+                       fileTime, tableTime);
+                return 1;
+            }
+        }
+        printf("%s: the same %zu cues as %s\n", showPath, cues.size(), show->filename);
+        return 0;
+    }
+    CueTable table(cues.data(), cues.size());
+
+    WavFile wav;
+    if (audioPath && !wav.open(audioPath))
+    {
+        fprintf(stderr, "%s: not a 16 bit PCM wav file\n", audioPath);
+        return 1;
+    }
+    if (!end)
+        end = audioPath ? (uint64_t)wav.totalSamples * 1000 / wav.sampleRate : (cues.empty() ? 0 : cues.back().time) + 5000;
+
+    FILE *out = nullptr;
+    if (outPath && !(out = fopen(outPath, "wb")))
+    {
+        fprintf(stderr, "%s: can't write\n", outPath);
+        return 1;
+    }
+    FILE *cacheOut = nullptr;
+    if (cachePath && !(cacheOut = fopen(cachePath, "wb")))
+    {
+        fprintf(stderr, "%s: can't write\n", cachePath);
+        return 1;
+    }
+    CacheWriter cache;
+
+    const uint32_t framePeriod = 1000000 / FRAMES_PER_SECOND;
+    FrameFileHeader fileHeader = {{'L', 'E', 'D', 'F'}, FRAMEFILE_VERSION, NUM_LEDS, framePeriod, 0};
+    FastLED.addLeds(leds, NUM_LEDS);
+
+    double seconds = 0;
+    uint32_t frames = 0;
+    for (int run = 0; run < repeats; run++)
+    {
+        // fresh clock, fft and detector for every run so each render is identical. they can't be assigned
+        host::setMicros(0);
+        fft256_1.~AudioAnalyzeFFT256();
+        new (&fft256_1) AudioAnalyzeFFT256();
+        fft256_1.averageTogether(3);
+        beatDetector.~BeatDetector();
+        new (&beatDetector) BeatDetector(fft256_1);
+        FastLED.setBrightness(BRIGHTNESS);
+        uint64_t samples = 0;
+        if (audioPath)
+            wav.rewind();
+
+        // the audio up to the next frame time through the fft and the beat detector
+        auto feedAudio = [&](uint32_t untilMicros, bool everyFftFrame)
+        {
+            int16_t block[AUDIO_BLOCK_SAMPLES];
+            while (audioPath && (samples + AUDIO_BLOCK_SAMPLES) * 1000000 / wav.sampleRate <= untilMicros &&
+                   wav.readMono(block, AUDIO_BLOCK_SAMPLES) == AUDIO_BLOCK_SAMPLES)
+            {
+                samples += AUDIO_BLOCK_SAMPLES;
+                fft256_1.update(block);
+                if (everyFftFrame)
+                {
+                    host::setMicros(samples * 1000000 / wav.sampleRate);
+                    beatDetector.BeatDetectorLoop();
+                }
+            }
+            host::setMicros(untilMicros);
+        };
+
+        auto startTime = std::chrono::steady_clock::now();
+        feedAudio(start * 1000, true);
+        rebuildShow(table, start, framePeriod);
+
+        if (out && run == 0)
+            fwrite(&fileHeader, sizeof(fileHeader), 1, out);
+        for (uint32_t frame = start * 1000 / framePeriod; frame * framePeriod < end * 1000; frame++)
+        {
+            uint32_t time = frame * framePeriod;
+            feedAudio(time, false);
+            beatDetector.BeatDetectorLoop(); // once per frame, like loop()
+            renderFrame(time / 1000, profile ? profiledCue : runCue);
+
+            if (out && run == 0)
+            {
+                FrameHeader frameHeader = {time / 1000, FastLED.getBrightness(), {0, 0, 0}};
+                fwrite(&frameHeader, sizeof(frameHeader), 1, out);
+                fwrite(leds, sizeof(CRGB), NUM_LEDS, out);
+                fileHeader.frameCount++;
+            }
+            if (cacheOut && run == 0 && cacheableFrame())
+                cache.add(frame, leds);
+            frames++;
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    double songSeconds = (end - start) / 1000.0;
+    printf("%s: %.1f s of show, %d run(s)\n", showPath ? showPath : showName, songSeconds, repeats);
+    printf("frames: %u in %.3f s -> %.0f frames/s, %.0fx realtime, %.2f us per frame\n",
+           frames, seconds, frames / seconds, songSeconds * repeats / seconds, seconds * 1e6 / frames);
+
+    if (profile)
+    {
+        printf("\n%-16s %10s %12s %14s\n", "action", "calls", "ns/call", "ns/frame");
+        for (int action = 0; action < 256; action++)
+        {
+            if (actionCalls[action])
+                printf("%-16s %10u %12.1f %14.1f\n", action <= CUE_FADE_TO_BLACK ? actionNames[action] : "?",
+                       actionCalls[action], actionNanos[action] / actionCalls[action], actionNanos[action] / frames);
+        }
+    }
+
+    if (out)
+    {
+        fseek(out, 0, SEEK_SET);
+        fwrite(&fileHeader, sizeof(fileHeader), 1, out);
+        printf("%u frames, %ld bytes -> %s\n", fileHeader.frameCount, (long)sizeof(fileHeader) + (long)fileHeader.frameCount * (sizeof(FrameHeader) + 3 * NUM_LEDS), outPath);
+        fclose(out);
+    }
+
+    if (cacheOut)
+    {
+        std::vector<uint8_t> bytes = cache.file(framePeriod, frameCacheShowId(table));
+        fwrite(bytes.data(), 1, bytes.size(), cacheOut);
+        fclose(cacheOut);
+        uint32_t size = bytes.size();
+        printf("cache: %u of %u frames in %u spans, %u bytes (%.1f%% of raw) -> %s\n", cache.frameCount, frames / repeats, cache.spanCount,
+               size, cache.frameCount ? 100.0 * size / (cache.frameCount * 3.0 * NUM_LEDS) : 0.0, cachePath);
+    }
+    return 0;
+}
@@ -0,0 +1,363 @@
+/*
+ * Offline replay harness for BeatDetector.
+ *
+ * Feeds a WAV file through the host AudioAnalyzeFFT256 and BeatDetector at full
+ * CPU speed and prints every detected beat, the bpm and how fast the detector ran.
+ * Build and run with:
+ *   pio run -e native
+ *   .pio/build/native/program song.wav
+ *
+ * options:
+ *   -q        don't print individual beats, only the summary
+ *   -n COUNT  replay the file COUNT times (throughput benchmark)
+ *   -b        also benchmark the spectral flux kernel and float vs fixed point band detection on the song's fft frames
+ *   -w FILE   write the detected beats as a beat map (.beats sidecar for the sd card, see BeatMapFormat.h)
+ *   -t FILE   write the beat detection telemetry packets to FILE, for tools/telemetry.py
+ *   -l MS     lookahead: pretend the audio output is MS behind the fft, beats are reported when they are heard
+ */
+
+#include <Audio.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "BeatDetector.h"
+#include "BeatMapFormat.h"
+#include "WavFile.h"
+
+typedef std::array<uint16_t, 128> Bins;
+
+// runs the simd and the portable spectral flux kernel over every recorded frame and
+// compares them against the time available per fft frame on the device.
+static void benchmarkSpectralFlux(const std::vector<Bins> &song, const int16_t *weights)
+{
+    const int passes = 200;
+    uint16_t previous[128] __attribute__((aligned(16)));
+    uint64_t check[2] = {0, 0};
+    double nanos[2] = {0, 0};
+
+    for (int kernel = 0; kernel < 2; kernel++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++)
+        {
+            memset(previous, 0, sizeof(previous));
+            for (const Bins &bins : song)
+            {
+                check[kernel] += kernel ? spectralFluxScalar(bins.data(), previous, weights, 128)
+                                        : spectralFlux(bins.data(), previous, weights, 128);
+            }
+        }
+        nanos[kernel] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ((double)passes * song.size());
+    }
+
+    double budget = 1e9 * 3 * AUDIO_BLOCK_SAMPLES / AUDIO_SAMPLE_RATE_EXACT; // one fft frame with averageTogether(3)
+    printf("spectral flux: %.1f ns/frame simd, %.1f ns/frame scalar (%.5f%% of the %.2f ms fft period)%s\n",
+           nanos[0], nanos[1], 100 * nanos[0] / budget, budget / 1e6, check[0] == check[1] ? "" : " RESULTS DIFFER");
+}
+
+// float vs fixed point band detectors (BandDetector.h / FixedBandDetector.h), each fed the way
+// BeatDetector feeds it: read() for float, the raw sum of output[] for fixed point
+static void benchmarkBands(const std::vector<Bins> &song)
+{
+    const int passes = 50;
+    double nanos[2] = {0, 0};
+    uint32_t beats[2] = {0, 0};
+    std::vector<uint8_t> fired[2]; // bit per band of every frame in the first pass
+
+    for (int kernel = 0; kernel < 2; kernel++)
+    {
+        for (int pass = 0; pass < passes; pass++)
+        {
+            host::setMicros(0);
+            std::vector<BandDetector<MAX_BAND_WINDOW>> floatBands;
+            std::vector<FixedBandDetector<MAX_BAND_WINDOW>> fixedBands;
+            for (const BandConfig &band : BEAT_BANDS)
+            {
+                floatBands.emplace_back(band);
+                fixedBands.emplace_back(band);
+            }
+
+            uint64_t frameMicros = 0;
+            for (const Bins &bins : song)
+            {
+                frameMicros += 1000000 * 3 * AUDIO_BLOCK_SAMPLES / AUDIO_SAMPLE_RATE_EXACT;
+                host::setMicros(frameMicros); // retrigger times need the clock
+                uint8_t frameBeats = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < NUM_BEAT_BANDS; i++)
+                {
+                    uint32_t sum = 0;
+                    for (int bin = BEAT_BANDS[i].firstBin; bin <= BEAT_BANDS[i].lastBin; bin++)
+                        sum += bins[bin];
+                    float beat = kernel ? fixedBands[i].update(sum) : floatBands[i].update(sum * (1.0f / 16384.0f));
+                    beats[kernel] += beat != 0;
+                    frameBeats |= (beat != 0) << i;
+                }
+                nanos[kernel] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                if (pass == 0)
+                    fired[kernel].push_back(frameBeats);
+            }
+        }
+    }
+    uint32_t differences = 0;
+    for (size_t frame = 0; frame < song.size(); frame++)
+        differences += fired[0][frame] != fired[1][frame];
+    double frames = (double)passes * song.size();
+    printf("band detection (%d bands): %.1f ns/frame float, %.1f ns/frame fixed point, %u vs %u beats, %u frames differ\n",
+           NUM_BEAT_BANDS, nanos[0] / frames, nanos[1] / frames, beats[0] / passes, beats[1] / passes, differences);
+}
+
+static uint8_t strength(float beat)
+{
+    return beat >= 1 ? 255 : (uint8_t)(beat * 255);
+}
+
+static bool writeBeatMap(const char *path, std::vector<BeatMapEvent> &events, uint32_t sampleRate)
+{
+    // band beats are moved back by the detection latency, virtual beats already are where the
+    // beat clock put them, so the stream has to be sorted before writing
+    std::stable_sort(events.begin(), events.end(), [](const BeatMapEvent &a, const BeatMapEvent &b)
+                     { return a.sample < b.sample; });
+
+    BeatMapHeader header;
+    memcpy(header.magic, BEATMAP_MAGIC, 4);
+    header.version = BEATMAP_VERSION;
+    header.reserved = 0;
+    header.sampleRate = sampleRate;
+    header.eventCount = events.size();
+
+    FILE *out = fopen(path, "wb");
+    if (!out)
+        return false;
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(events.data(), sizeof(BeatMapEvent), events.size(), out) == events.size();
+    return fclose(out) == 0 && ok;
+}
+
+// stands in for Serial when draining telemetry, never full
+struct TelemetryFile
+{
+    FILE *out = nullptr;
+    int availableForWrite() { return 4096; }
+    size_t write(const uint8_t *buffer, size_t size) { return fwrite(buffer, 1, size, out); }
+};
+
+static void usage()
+{
+    fprintf(stderr, "usage: program [-q] [-b] [-n COUNT] [-l MS] [-t FILE] [-w FILE.beats] file.wav\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    bool quiet = false;
+    bool benchmark = false;
+    int repeats = 1;
+    uint32_t lookahead = 0;
+    const char *path = nullptr;
+    const char *beatMapPath = nullptr;
+    const char *telemetryPath = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-q"))
+            quiet = true;
+        else if (!strcmp(argv[i], "-b"))
+            benchmark = true;
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            beatMapPath = argv[++i];
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            telemetryPath = argv[++i];
+        else if (!strcmp(argv[i], "-l") && i + 1 < argc)
+            lookahead = atoi(argv[++i]) * 1000;
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            repeats = atoi(argv[++i]);
+        else if (argv[i][0] == '-')
+            usage();
+        else
+            path = argv[i];
+    }
+    if (!path || repeats < 1)
+        usage();
+
+    WavFile wav;
+    if (!wav.open(path))
+    {
+        fprintf(stderr, "%s: not a 16 bit PCM wav file\n", path);
+        return 1;
+    }
+    if (wav.sampleRate != (uint32_t)AUDIO_SAMPLE_RATE_EXACT)
+        fprintf(stderr, "warning: %s is %u Hz, the detector is tuned for %.0f Hz\n", path, wav.sampleRate, AUDIO_SAMPLE_RATE_EXACT);
+
+    TelemetryFile telemetryFile;
+    if (telemetryPath && !(telemetryFile.out = fopen(telemetryPath, "wb")))
+    {
+        fprintf(stderr, "%s: can't write\n", telemetryPath);
+        return 1;
+    }
+
+    uint32_t frames = 0;
+    uint32_t lowBeats = 0, midBeats = 0, highBeats = 0, onsetBeats = 0, virtualBeats = 0;
+    std::vector<Bins> song; // fft frames of the first run, for the kernel benchmark
+    std::vector<uint32_t> virtualBeatTimes; // of the first run, for the beat clock jitter
+    std::vector<BeatMapEvent> beatMap;       // of the first run, for -w
+    uint16_t mappedTempo = 0;
+    uint8_t mappedConfidence = 0;
+    int16_t fluxWeights[128];
+    std::map<int, int> bpmVotes; // valid bpm readings seen -> how often
+    double seconds = 0;         // whole replay, fft included
+    double detectorSeconds = 0; // time spent inside BeatDetectorLoop() only
+
+    for (int run = 0; run < repeats; run++)
+    {
+        // fresh clock and detector for every run so each replay is identical
+        host::setMicros(0);
+        AudioAnalyzeFFT256 fft256_1;
+        fft256_1.averageTogether(3);
+        BeatDetector beatDetector(fft256_1);
+        beatDetector.lookahead = lookahead;
+        beatDetector.enableSerialBeatDisplay = telemetryFile.out && run == 0;
+        wav.rewind();
+        bool report = !quiet && run == 0;
+
+        int16_t block[AUDIO_BLOCK_SAMPLES];
+        uint64_t samples = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (wav.readMono(block, AUDIO_BLOCK_SAMPLES) == AUDIO_BLOCK_SAMPLES)
+        {
+            samples += AUDIO_BLOCK_SAMPLES;
+            host::setMicros(samples * 1000000 / wav.sampleRate);
+            fft256_1.update(block);
+
+            auto detectStart = std::chrono::steady_clock::now();
+            bool fresh = beatDetector.BeatDetectorLoop();
+            detectorSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - detectStart).count();
+            if (fresh)
+            {
+                frames++;
+                if (beatDetector.validBPM)
+                    bpmVotes[beatDetector.bpm]++;
+                if (benchmark && run == 0)
+                {
+                    song.emplace_back();
+                    memcpy(song.back().data(), fft256_1.output, sizeof(fft256_1.output));
+                }
+            }
+
+            if (telemetryFile.out)
+                beatDetector.telemetry.drain(telemetryFile);
+
+            // virtualBeat can also come up between fft frames
+            lowBeats += beatDetector.lowBeat != 0;
+            midBeats += beatDetector.midBeat != 0;
+            highBeats += beatDetector.highBeat != 0;
+            onsetBeats += beatDetector.onsetBeat != 0;
+            virtualBeats += beatDetector.virtualBeat;
+            if (beatDetector.virtualBeat && run == 0)
+                virtualBeatTimes.push_back(beatDetector.virtualBeatMicros);
+
+            if (beatMapPath && run == 0)
+            {
+                auto toSample = [&](uint32_t us)
+                { return (uint32_t)((uint64_t)us * wav.sampleRate / 1000000); };
+                // us - latency, 0 at the start of the song before there was that much
+                auto before = [](uint32_t us, uint32_t latency)
+                { return us > latency ? us - latency : 0; };
+                // micros() is the position the fft has reached, the output is lookahead behind it
+                uint32_t beatAt = toSample(before(micros(), beatDetector.beatFlagLatency()));
+
+                uint8_t bands = (beatDetector.lowBeat ? BEATMAP_LOW : 0) | (beatDetector.midBeat ? BEATMAP_MID : 0) |
+                                (beatDetector.highBeat ? BEATMAP_HIGH : 0) | (beatDetector.onsetBeat ? BEATMAP_ONSET : 0);
+                if (bands)
+                {
+                    float level = std::max({beatDetector.lowBeat, beatDetector.midBeat, beatDetector.highBeat, beatDetector.onsetBeat});
+                    beatMap.push_back({beatAt, bands, strength(level), 0});
+                }
+                if (beatDetector.virtualBeat)
+                    beatMap.push_back({toSample(before(beatDetector.virtualBeatMicros, lookahead)), BEATMAP_VIRTUAL, 255, 0});
+
+                // tempo map: only when the tempo moved by half a bpm or it became valid/invalid
+                uint16_t tempo = beatDetector.validBPM ? (uint16_t)(beatDetector.tempo * 100 + 0.5) : 0;
+                uint8_t confidence = strength(beatDetector.tempoConfidence);
+                if (fresh && (tempo / 50 != mappedTempo / 50 || (confidence >= 255 * beatDetector.minTempoConfidence) != (mappedConfidence >= 255 * beatDetector.minTempoConfidence)))
+                {
+                    beatMap.push_back({toSample(micros()), BEATMAP_TEMPO, confidence, tempo});
+                    mappedTempo = tempo;
+                    mappedConfidence = confidence;
+                }
+            }
+
+            if (report && (beatDetector.lowBeat || beatDetector.midBeat || beatDetector.highBeat || beatDetector.onsetBeat || beatDetector.virtualBeat))
+            {
+                printf("%9.3f s %s %s %s %s %s bpm %3d\n", samples / (double)wav.sampleRate - lookahead / 1e6,
+                       beatDetector.lowBeat ? "low" : "   ",
+                       beatDetector.midBeat ? "mid" : "   ",
+                       beatDetector.highBeat ? "high" : "    ",
+                       beatDetector.onsetBeat ? "onset" : "     ",
+                       beatDetector.virtualBeat ? "virtual" : "       ",
+                       beatDetector.bpm);
+            }
+        }
+        memcpy(fluxWeights, beatDetector.fluxWeights, sizeof(fluxWeights));
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    int bestBpm = 0, bestVotes = 0;
+    for (auto &v : bpmVotes)
+    {
+        if (v.second > bestVotes)
+        {
+            bestBpm = v.first;
+            bestVotes = v.second;
+        }
+    }
+
+    double songSeconds = wav.totalSamples / (double)wav.sampleRate;
+    printf("\n%s: %.1f s of audio, %d run(s)\n", path, songSeconds, repeats);
+    printf("beats per run: low %u  mid %u  high %u  onset %u  virtual %u\n", lowBeats / repeats, midBeats / repeats, highBeats / repeats, onsetBeats / repeats, virtualBeats / repeats);
+    printf("bpm: %d (%d valid readings)\n", bestBpm, bestVotes / repeats);
+    printf("fft frames: %u in %.3f s -> %.0f frames/s, %.0fx realtime\n", frames, seconds, frames / seconds, songSeconds * repeats / seconds);
+    printf("detector: %.3f us per fft frame\n", detectorSeconds * 1e6 / frames);
+
+    // beat clock stability over the second half of the song, when it should be locked
+    double sum = 0, sumSquares = 0;
+    int intervals = 0;
+    for (size_t i = virtualBeatTimes.size() / 2 + 1; i < virtualBeatTimes.size(); i++)
+    {
+        double interval = (virtualBeatTimes[i] - virtualBeatTimes[i - 1]) / 1000.0;
+        sum += interval;
+        sumSquares += interval * interval;
+        intervals++;
+    }
+    if (intervals > 1)
+    {
+        double mean = sum / intervals;
+        printf("virtual beat interval (second half): %.2f ms +- %.2f ms\n", mean, sqrt(sumSquares / intervals - mean * mean));
+    }
+
+    if (beatMapPath)
+    {
+        if (!writeBeatMap(beatMapPath, beatMap, wav.sampleRate))
+        {
+            fprintf(stderr, "%s: write failed\n", beatMapPath);
+            return 1;
+        }
+        printf("beat map: %zu events, %zu bytes -> %s\n", beatMap.size(), sizeof(BeatMapHeader) + beatMap.size() * sizeof(BeatMapEvent), beatMapPath);
+    }
+
+    if (telemetryFile.out)
+    {
+        printf("telemetry: %ld bytes -> %s\n", ftell(telemetryFile.out), telemetryPath);
+        fclose(telemetryFile.out);
+    }
+
+    if (benchmark)
+    {
+        benchmarkSpectralFlux(song, fluxWeights);
+        benchmarkBands(song);
+    }
+    return 0;
+}
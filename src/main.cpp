@@ -5,26 +5,31 @@
 #include <SD.h>
 #include <SerialFlash.h>
 #include <OctoWS2811.h>
-#include <Bounce2.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
 #define FASTLED_INTERNAL
 #include <FastLED.h>
 
 #include "CTeensy4Controller.h"
 #include "BeatDetector.h"
-
-// RGB LED
-// Any group of digital pins may be used
-const int numPins = 1;
-byte pinList[numPins] = {2};
-
-const int ledsPerStrip = 120;
-const int NUM_LEDS = numPins * ledsPerStrip;
-CRGB leds[NUM_LEDS];
-CRGBSet ledset(leds, NUM_LEDS);
+#include "BeatMap.h"
+#include "Benchmarks.h"
+#include "ButtonTrigger.h"
+#include "FrameCache.h"
+#include "FrameScheduler.h"
+#include "LatencyProbe.h"
+#include "Patterns.h"
+#include "Playlist.h"
+#include "ShowFile.h"
+#include "Shows.h"
+#include "Sidecar.h"
+#include "WavPlayer.h"
+
+// RGB LED, see LedLayout.h
+// Any group of digital pins may be used. The strips are on the first numPins of these,
+// which the audio shield, the sd card, the buzzer and the white leds leave free
+byte pinList[8] = {2, 3, 4, 9, 15, 16, 17, 22};
 
 // These buffers need to be large enough for all the pixels.
 // The total number of pixels is "ledsPerStrip * numPins".
@@ -41,16 +46,26 @@ OctoWS2811 octo(ledsPerStrip, displayMemory, drawingMemory, config, numPins, pin
 
 CTeensy4Controller<GRB, WS2811_800kHz> *pcontroller;
 
+// Lookahead: the speakers get the audio this much later than the fft, so beats are found
+// before they are heard and can be shown exactly on time instead of trailing the music.
+// Needs to be more than BeatDetector::detectionLatency plus a loop or two to be exact.
+#define LOOKAHEAD_MS 40
+const int lookaheadBlocks = LOOKAHEAD_MS * AUDIO_SAMPLE_RATE_EXACT / 1000 / AUDIO_BLOCK_SAMPLES + 2; // audio memory for one delay line
+
 // Audio Player
-AudioPlaySdWav playSdWav1;
+WavPlayer playSdWav1; // AudioPlaySdWav that can seek
 AudioMixer4 mixer1;
 AudioAnalyzeFFT256 fft256_1;
+AudioEffectDelay delay1;
+AudioEffectDelay delay2;
 AudioOutputI2S i2s1;
-AudioConnection patchCord1(playSdWav1, 0, i2s1, 0);
+AudioConnection patchCord1(playSdWav1, 0, delay1, 0);
 AudioConnection patchCord2(playSdWav1, 0, mixer1, 0);
-AudioConnection patchCord3(playSdWav1, 1, i2s1, 1);
+AudioConnection patchCord3(playSdWav1, 1, delay2, 0);
 AudioConnection patchCord4(playSdWav1, 1, mixer1, 1);
 AudioConnection patchCord5(mixer1, fft256_1);
+AudioConnection patchCord6(delay1, 0, i2s1, 0);
+AudioConnection patchCord7(delay2, 0, i2s1, 1);
 AudioControlSGTL5000 sgtl5000_1;
 
 BeatDetector beatDetector(fft256_1);
@@ -65,10 +80,24 @@ BeatDetector beatDetector(fft256_1);
 
 // Buzzer pin
 #define BUZZER_PIN 5
-Bounce pushbutton = Bounce();
+ButtonTrigger button;
+LatencyProbe latencyProbe;
 
-#define BRIGHTNESS 96
-#define FRAMES_PER_SECOND 240
+// With the next song preloaded and nothing playing the press starts it right here: no sd
+// card access, only a few pointers in WavPlayer. Otherwise the loop takes the press.
+static void buttonInterrupt()
+{
+  if (button.edge(digitalReadFast(BUZZER_PIN) == LOW, micros()) && button.armed)
+  {
+    button.armed = false;
+    if (playSdWav1.playPreloaded())
+    {
+      button.startedSong();
+    }
+  }
+}
+
+static void discoverShows();
 
 void setup()
 {
@@ -86,7 +115,10 @@ void setup()
   mixer1.gain(3, 0);
   fft256_1.averageTogether(3); // I this gives me about 115 samples per second
 
-  AudioMemory(8);
+  AudioMemory(8 + 2 * lookaheadBlocks);
+  delay1.delay(0, LOOKAHEAD_MS);
+  delay2.delay(0, LOOKAHEAD_MS);
+  beatDetector.lookahead = LOOKAHEAD_MS * 1000;
   sgtl5000_1.enable();
   sgtl5000_1.volume(0.5);
   sgtl5000_1.audioPostProcessorEnable();
@@ -102,754 +134,424 @@ void setup()
       delay(500);
     }
   }
+  discoverShows();
+  playlist.begin(gNumberOfSongs);
 
   pinMode(BUZZER_PIN, INPUT_PULLUP);
   delay(100);
-  pushbutton.attach(BUZZER_PIN);
-  pushbutton.interval(10);
+  attachInterrupt(digitalPinToInterrupt(BUZZER_PIN), buttonInterrupt, CHANGE);
+  // same priority as the audio library's update interrupt, so the two never interrupt each
+  // other and playPreloaded() can't land in the middle of WavPlayer::update()
+  NVIC_SET_PRIORITY(IRQ_GPIO6789, 208);
 
   octo.begin();
-  pcontroller = new CTeensy4Controller<GRB, WS2811_800kHz>(&octo);
+  pcontroller = new CTeensy4Controller<GRB, WS2811_800kHz>(&octo, drawingMemory, ledsPerStrip);
 
   FastLED.setBrightness(BRIGHTNESS);
   FastLED.addLeds(pcontroller, leds, numPins * ledsPerStrip);
-}
 
-uint8_t gHue = 0; // rotating "base color" used by many of the patterns
-uint32_t gLastTimeCodeDoneAt = 0;
-uint32_t gLastTimeCodeDoneFrom = 0;
-
-#define TC(HOURS, MINUTES, SECONDS)                         \
-  ((uint32_t)(((uint32_t)((HOURS) * (uint32_t)(3600000))) + \
-              ((uint32_t)((MINUTES) * (uint32_t)(60000))) + \
-              ((uint32_t)((SECONDS) * (uint32_t)(1000)))))
-
-#define AT(HOURS, MINUTES, SECONDS) if (atTC(TC(HOURS, MINUTES, SECONDS)))
-#define FROM(HOURS, MINUTES, SECONDS) if (fromTC(TC(HOURS, MINUTES, SECONDS)))
-
-static bool atTC(uint32_t tc)
-{
-  bool maybe = false;
-  if (playSdWav1.positionMillis() >= tc)
-  {
-    if (gLastTimeCodeDoneAt < tc)
-    {
-      maybe = true;
-      gLastTimeCodeDoneAt = tc;
-    }
-  }
-  return maybe;
+#ifdef BEATBUZZER_BENCH
+  runBenchmarks();
+#endif
 }
 
-static bool fromTC(uint32_t tc)
-{
-  bool maybe = false;
-  if (playSdWav1.positionMillis() >= tc)
-  {
-    if (gLastTimeCodeDoneFrom <= tc)
-    {
-      maybe = true;
-      gLastTimeCodeDoneFrom = tc;
-    }
-  }
-  return maybe;
-}
+// frames on the audio clock instead of a fixed delay. after show() the strip still needs
+// 30 µs per led plus the 300 µs reset before the frame is there, more while the frame before
+// is still going out (outputMicros())
+FrameScheduler frameScheduler(1000000 / FRAMES_PER_SECOND, ledsPerStrip * 30 + 300);
 
-void quarters(const CRGB &color1, const CRGB &color2, const CRGB &color3, const CRGB &color4);
-void pulsing();
-void rainbow();
-void rainbowWithGlitter();
-void addGlitter(fract8 chanceOfGlitter);
-void confetti();
-void bpm(uint8_t BeatsPerMinute);
-void juggle();
-void applause(uint8_t width);
-void fadeToBlack();
-void twoDots();
-void fillAndCC();
-void blinkyblink2();
-void spewFour();
-void spew();
-void sinelon();
-void flashAtBpm(uint8_t BeatsPerMinute, CHSV hue);
-void wiggleLines(uint8_t BeatsPerMinute);
-void singleFlashAT(uint32_t seconds, CRGB color);
-void flashPulsing();
-void fillGradual(uint8_t BeatsPerMinute);
-
-// There are two kinds of things you can put into this performance:
-// "FROM" and "AT".
-//
-// * "FROM" means starting FROM this time AND CALLING IT REPEATEDLY
-//   until the next "FROM" time comes.
-//
-// * "AT" means do this ONE TIME ONLY "AT" the designated time.
-//
-// At least one of the FROM clauses will ALWAYS be executed.
-// In the transitional times, TWO pieces of code will be executed back to back.
-// For example, if one piece says "FROM(0,0,1.000) {DrawRed()}" and another says
-// "FROM(0,0,2.000) {flashblue();}", what you'll get is this:
-//   00:00:01.950  -> calls DrawRed
-//   00:00:01.975  -> calls DrawRed
-//   00:00:02.000  -> calls DrawRed AND calls DrawBlue !
-//   00:00:02.025  -> calls DrawBlue
-//   00:00:02.050  -> calls DrawBlue
-// In most cases, this probably isn't significant in practice, but it's important
-// to note.  It could be avoided by listing the sequence steps in reverse
-// chronological order, but that makes it hard to read.
-void StayinAlive()
+// from now until the frame just shown is on the strip
+static uint32_t outputMicros()
 {
-  AT(0, 0, 00.001) { FastLED.setBrightness(BRIGHTNESS); }
-  FROM(0, 0, 00.120) { bpm(103); }
-  FROM(0, 0, 23.180) { quarters(CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black); }
-  FROM(0, 0, 23.763) { quarters(CRGB::Red, CRGB::Green, CRGB::Black, CRGB::Black); }
-  FROM(0, 0, 24.346) { quarters(CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Black); }
-  FROM(0, 0, 24.929) { quarters(CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Yellow); }
-  FROM(0, 0, 25.512) { pulsing(); }
-  FROM(0, 0, 27.890) { fill_solid(leds, NUM_LEDS, CRGB::Orange); }
-  FROM(0, 0, 28.473) { fill_solid(leds, NUM_LEDS, CRGB::White); }
-  FROM(0, 0, 29.056) { fill_solid(leds, NUM_LEDS, CRGB::Blue); }
-  FROM(0, 0, 29.639) { fill_solid(leds, NUM_LEDS, CRGB::Pink); }
-  FROM(0, 0, 29.722) { pulsing(); }
-  FROM(0, 0, 32.550) { quarters(CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black); }
-  FROM(0, 0, 33.133) { quarters(CRGB::Red, CRGB::Green, CRGB::Black, CRGB::Black); }
-  FROM(0, 0, 33.716) { quarters(CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Black); }
-  FROM(0, 0, 34.299) { quarters(CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Yellow); }
-  FROM(0, 0, 34.882) { pulsing(); }
-  FROM(0, 0, 37.125) { fill_solid(leds, NUM_LEDS, CRGB::Orange); }
-  FROM(0, 0, 37.708) { fill_solid(leds, NUM_LEDS, CRGB::White); }
-  FROM(0, 0, 38.291) { fill_solid(leds, NUM_LEDS, CRGB::Blue); }
-  FROM(0, 0, 38.874) { fill_solid(leds, NUM_LEDS, CRGB::Pink); }
-  FROM(0, 0, 39.457) { pulsing(); }
-  // FROM(0, 0, 39.457) { bpm(103); }
-  FROM(0, 0, 49.800) { fadeToBlackBy(leds, NUM_LEDS, 1); }
+  int32_t until = pcontroller->visibleMicros() - micros();
+  return until > 0 ? until : 0;
 }
 
-void Celebrate() {
-  AT(0, 0, 00.001) { FastLED.setBrightness(BRIGHTNESS); }
-  FROM(0, 0, 00.012) { quarters(CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black); }
-
-  FROM(0, 0, 1.06) { bpm(60);}
-  FROM(0, 0, 5.620) { fillGradual(30);}
-  FROM(0, 0, 7.149) { bpm(60);}
-
-  FROM(0, 0, 9.175) { quarters(CRGB::Salmon, CRGB::Black, CRGB::Black, CRGB::Black);}
-  FROM(0, 0, 9.667) { quarters(CRGB::Black, CRGB::Black, CRGB::Blue, CRGB::Black);}
-  FROM(0, 0, 10.185) { quarters(CRGB::Black, CRGB::Green, CRGB::Black, CRGB::Black);}
-  FROM(0, 0, 10.677) { quarters(CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Orange);}
-
-  FROM(0, 0, 11.185) { quarters(CRGB::Black, CRGB::Salmon, CRGB::Black, CRGB::Black);}
-  FROM(0, 0, 11.435) { quarters(CRGB::Black, CRGB::Salmon, CRGB::LightBlue, CRGB::Black);}
-  FROM(0, 0, 11.682) { quarters(CRGB::Lime, CRGB::Salmon, CRGB::LightBlue, CRGB::Black);}
-  FROM(0, 0, 11.938) { quarters(CRGB::Lime, CRGB::Salmon, CRGB::LightBlue, CRGB::Red);}
-
-  FROM(0, 0, 13.222) { bpm(60);}
-  FROM(0,0,16.471) { applause(30); }
-
-  FROM(0, 0, 17.220) { bpm(60);}
-  FROM(0, 0, 20.704) { wiggleLines(60);}
-
-  FROM(0, 0, 21.692) { bpm(60);}
-
-  FROM(0, 0, 25.188) { quarters(CRGB::Salmon, CRGB::Black, CRGB::Black, CRGB::Black);}
-  FROM(0, 0, 25.667) { quarters(CRGB::Black, CRGB::Black, CRGB::Blue, CRGB::Black);}
-  FROM(0, 0, 26.185) { quarters(CRGB::Black, CRGB::Green, CRGB::Black, CRGB::Black);}
-  FROM(0, 0, 26.677) { quarters(CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Orange);}
-
-  FROM(0, 0, 27.185) { quarters(CRGB::Black, CRGB::Salmon, CRGB::Black, CRGB::Black);}
-  FROM(0, 0, 27.435) { quarters(CRGB::Black, CRGB::Salmon, CRGB::LightBlue, CRGB::Black);}
-  FROM(0, 0, 27.682) { quarters(CRGB::Lime, CRGB::Salmon, CRGB::LightBlue, CRGB::Black);}
-  FROM(0, 0, 27.938) { quarters(CRGB::Lime, CRGB::Salmon, CRGB::LightBlue, CRGB::Red);}
+// where playSdWav1 was last seen playing and when. once it stops the end of the song is
+// still in the delay lines for LOOKAHEAD_MS, the show goes on from here until it is heard
+static uint32_t lastPlayingPosition = 0;
+static uint32_t lastPlayingMicros = 0;
 
-  FROM(0, 0, 28.645) { wiggleLines(60);}
-
-  FROM(0, 0, 29.644) { bpm(60);}
-  FROM(0, 0, 46.5) { fadeToBlackBy(leds, NUM_LEDS, 1); }
-}
-
-void Astro()
+static bool songStillAudible()
 {
-  AT(0, 0, 00.001) { FastLED.setBrightness(BRIGHTNESS); }
-
-  FROM(0, 0, 00.012) { quarters(CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black); }
-
-  FROM(0, 0, 0.983) { flashPulsing();}
-  FROM(0, 0, 05.454) { wiggleLines(127); }
-  FROM(0, 0, 06.604) { flashPulsing();}
-  FROM(0, 0, 07.348) { wiggleLines(127); }
-  FROM(0, 0, 08.546) { flashPulsing();}
-  FROM(0, 0, 13.086) { wiggleLines(127); }
-  FROM(0, 0, 14.276) { flashPulsing();}
-  FROM(0, 0, 14.982) { wiggleLines(127); }
-  FROM(0, 0, 16.189) { flashPulsing();}
-  FROM(0, 0, 20.697) { wiggleLines(127); }
-  FROM(0, 0, 21.983) { flashPulsing();}
-  FROM(0, 0, 22.622) { wiggleLines(127); }
-  FROM(0, 0, 23.8) { flashPulsing();}
-  FROM(0,0,27.454){ applause(1); }
-  singleFlashAT(30.215, CRGB::White);
-  FROM(0, 0, 30.8) { fadeToBlackBy(leds, NUM_LEDS, 1); }
+  return micros() - lastPlayingMicros < LOOKAHEAD_MS * 1000;
 }
 
-void RamaLama()
+// position of what is heard right now, playSdWav1 is LOOKAHEAD_MS ahead of the speakers
+static uint32_t audiblePositionMicros()
 {
-  AT(0, 0, 00.001) { FastLED.setBrightness(BRIGHTNESS); }
-
-  // Rama Lam
-  FROM(0, 0, 01.100) { quarters(CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black); }
-  // Ding Dong
-  FROM(0, 0, 01.629) { quarters(CRGB::LawnGreen, CRGB::Black, CRGB::LawnGreen, CRGB::Black); }
-  FROM(0, 0, 02.085) { quarters(CRGB::Black, CRGB::Salmon, CRGB::Black, CRGB::Salmon); }
-
-  // Rama Lam
-  FROM(0, 0, 02.587) { quarters(CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black); }
-  // Ding Ding Dong
-  FROM(0, 0, 03.604) { quarters(CRGB::Salmon, CRGB::Black, CRGB::Black, CRGB::Black); }
-  FROM(0, 0, 03.860) { quarters(CRGB::Salmon, CRGB::Black, CRGB::Salmon, CRGB::Black); }
-  FROM(0, 0, 04.094) { quarters(CRGB::Black, CRGB::LawnGreen, CRGB::Black, CRGB::LawnGreen); }
-
-  // Ramalamalamalamalamadingdong Ramalamalamalamalamading
-  FROM(0, 0, 04.621) { quarters(CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black); }
-  // Uhuh Uhuhuh Uhuhuhuh Uhuhuhuhuhuhu
-  FROM(0, 0, 08.454) { bpm(127); }
-  // Uuuuh Aaaaah
-  FROM(0, 0, 19.880) { bpm(254); }
-  // Ah.
-  FROM(0, 0, 21.730) { quarters(CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black); }
-
-  // O ohoh ohoh ohoh
-  FROM(0, 0, 22.228) { quarters(CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black); }
-  FROM(0, 0, 22.702) { quarters(CRGB::Red, CRGB::Green, CRGB::Black, CRGB::Black); }
-  FROM(0, 0, 23.304) { quarters(CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::Black); }
-
-  // Ive got a girl named
-  FROM(0, 0, 23.610) { bpm(127); }
-
-  // Rama Lama Lama Lama
-  FROM(0, 0, 25.731) { applause(5); }
-  // Ding Dong
-  FROM(0, 0, 26.968) { quarters(CRGB::Red, CRGB::Black, CRGB::Black, CRGB::Black); }
-  FROM(0, 0, 27.187) { quarters(CRGB::Black, CRGB::Black, CRGB::Red, CRGB::Black); }
-  // She said a thing to me
-  FROM(0, 0, 27.450) { bpm(127); }
-  // Rama Lama Lama Lama
-  FROM(0, 0, 29.5) { applause(5); }
-  // Ding Dong
-  FROM(0, 0, 30.742) { quarters(CRGB::Black, CRGB::Green, CRGB::Black, CRGB::Black); }
-  FROM(0, 0, 31.013) { quarters(CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Green); }
-
-  // I never set her free, cause shes mine oh
-  FROM(0, 0, 31.261) { bpm(127); }
-  // Miiiiine
-  FROM(0, 0, 34.985) { applause(1); }
-  // Uuuuuuha aaaaaaaah
-
-  FROM(0, 0, 34.985) { applause(1); }
-  AT(0, 0, 37) { FastLED.setBrightness(BRIGHTNESS / 2); }
-  FROM(0, 0, 37) { applause(2); }
-  AT(0, 0, 38) { FastLED.setBrightness(BRIGHTNESS / 4); }
-  FROM(0, 0, 38) { applause(3); }
-  AT(0, 0, 39) { FastLED.setBrightness(BRIGHTNESS / 6); }
-  FROM(0, 0, 39) { applause(4); }
-  AT(0, 0, 40) { FastLED.setBrightness(BRIGHTNESS / 8); }
-  AT(0, 0, 41) { FastLED.setBrightness(BRIGHTNESS / 10); }
-  FROM(0, 0, 41) { applause(5); }
-  FROM(0, 0, 41.5) { fadeToBlackBy(leds, NUM_LEDS, 1); }
-
-  // aaaaaaaaah
+  uint32_t position = playSdWav1.isPlaying() ? playSdWav1.positionMicros() : lastPlayingPosition + (micros() - lastPlayingMicros);
+  return position > LOOKAHEAD_MS * 1000 ? position - LOOKAHEAD_MS * 1000 : 0;
 }
 
-void Demo()
+// Songs to pick from: the shows in Shows.cpp, plus every song.wav on the sd card that has a
+// song.show next to it, found at boot. A song.show next to one of the compiled in shows is
+// played instead of its compiled in cues, so a show can be changed without reflashing.
+struct Song
 {
-  AT(0, 0, 00.001) { FastLED.setBrightness(BRIGHTNESS); }
-  FROM(0, 0, 01.500) { juggle(); }
-  FROM(0, 0, 03.375) { rainbowWithGlitter(); }
-  FROM(0, 0, 04.333) { bpm(62); }
-  FROM(0, 0, 06.666) { juggle(); }
-  FROM(0, 0, 08.750) { confetti(); }
-  AT(0, 0, 11.000) { gHue = HUE_PINK; }
-  AT(0, 0, 12.000) { fill_solid(leds, NUM_LEDS, CRGB::Red); }
-  AT(0, 0, 15.000) { fill_solid(leds, NUM_LEDS, CRGB::Blue); }
-  FROM(0, 0, 16.500) { fadeToBlack(); }
-  FROM(0, 0, 18.000) { applause(1); }
-  AT(0, 0, 19.000) { FastLED.setBrightness(BRIGHTNESS / 2); }
-  AT(0, 0, 20.000) { FastLED.setBrightness(BRIGHTNESS / 4); }
-  AT(0, 0, 21.000) { FastLED.setBrightness(BRIGHTNESS / 8); }
-  AT(0, 0, 22.000) { FastLED.setBrightness(BRIGHTNESS / 16); }
-  FROM(0, 0, 23.000) { fadeToBlack(); }
-}
-
-// List of patterns to cycle through.
-typedef void (*SimplePatternList[])();
-SimplePatternList gPatterns = {RamaLama, StayinAlive, Astro, Celebrate};
-char *gFilenames[4] = {"rldd.wav", "test2.wav", "astro.wav", "seleb.wav"};
-const uint8_t gNumberOfPatterns = 4;
-
-uint8_t gCurrentPatternNumber = 3; // Index number of which pattern is current
-
-void loop()
+  char filename[32];
+  const Show *show; // compiled in cues, nullptr for songs only found on the sd card
+};
+const uint8_t maxSongs = 32;
+Song gSongs[maxSongs];
+uint8_t gNumberOfSongs = 0;
+
+static void addSong(const char *filename, const Show *show)
 {
-  if (pushbutton.update())
+  if (gNumberOfSongs == maxSongs || strlen(filename) >= sizeof(gSongs[0].filename))
   {
-    digitalWrite(WHITE_LED_PIN, LOW);
-
-    if (playSdWav1.isPlaying() == false)
+    return;
+  }
+  for (int i = 0; i < gNumberOfSongs; i++)
+  {
+    if (!strcasecmp(gSongs[i].filename, filename))
     {
-      //gCurrentPatternNumber = (gCurrentPatternNumber + 1) % 3;
-      struct timespec ts;
-      clock_gettime(CLOCK_MONOTONIC, &ts);
-      /* using nano-seconds instead of seconds */
-      srand((time_t)ts.tv_nsec);
-
-      gCurrentPatternNumber = random8(rand()%gNumberOfPatterns);
-      delay(1000);
-      gLastTimeCodeDoneAt = 0;
-      gLastTimeCodeDoneFrom = 0;
-      Serial.println("Start playing");
-      playSdWav1.play(gFilenames[gCurrentPatternNumber]);
-      delay(10); // wait for library to parse WAV info
+      return;
     }
   }
+  strcpy(gSongs[gNumberOfSongs].filename, filename);
+  gSongs[gNumberOfSongs].show = show;
+  gNumberOfSongs++;
+}
 
-  if (playSdWav1.isPlaying())
+static void discoverShows()
+{
+  gNumberOfSongs = 0;
+  for (int i = 0; i < gNumberOfPatterns; i++)
   {
-    beatDetector.BeatDetectorLoop();
-
-    // StayinAlive();
-    gPatterns[gCurrentPatternNumber]();
+    addSong(gShows[i].filename, &gShows[i]);
+  }
 
-    // send the 'leds' array out to the actual LED strip
-    FastLED.show();
-    // insert a delay to keep the framerate modest
-    FastLED.delay(1000 / FRAMES_PER_SECOND);
-    // do some periodic updates
-    EVERY_N_MILLISECONDS(20) { gHue++; } // slowly cycle the "base color" through the rainbow
+  File root = SD.open("/");
+  while (File entry = root.openNextFile())
+  {
+    const char *name = entry.name();
+    size_t length = strlen(name);
+    if (!entry.isDirectory() && length > 5 && length < sizeof(gSongs[0].filename) && !strcasecmp(name + length - 5, ".show"))
+    {
+      char wav[sizeof(gSongs[0].filename)];
+      sidecarName(name, ".wav", wav, sizeof(wav));
+      if (SD.exists(wav))
+      {
+        addSong(wav, nullptr);
+      }
+    }
+    entry.close();
   }
-  else
+  root.close();
+
+  Serial.print(gNumberOfSongs);
+  Serial.println(" songs");
+  for (int i = 0; i < gNumberOfSongs; i++)
   {
-    FastLED.setBrightness(0);
-    FastLED.show();
-    digitalWrite(WHITE_LED_PIN, HIGH);
+    Serial.printf("%2d %s\n", i, gSongs[i].filename);
   }
 }
 
-void quarters(const CRGB &color1, const CRGB &color2, const CRGB &color3, const CRGB &color4)
-{
-  fill_solid(ledset(0, 35), 36, color1);
-  fill_solid(ledset(36, 59), 24, color2);
-  fill_solid(ledset(60, 95), 36, color3);
-  fill_solid(ledset(96, 119), 24, color4);
-}
 
-void rainbow()
+// What a song needs besides its audio, opened by openSongFiles(). There are two: the playing
+// song's and the next one's, which are opened while the song before still plays.
+struct SongFiles
 {
-  // FastLED's built-in rainbow generator
-  fill_rainbow(leds, NUM_LEDS, gHue, 7);
-}
+  uint8_t songNumber = 0;
+  CueTable cueTable;           // the show's compiled in cues
+  ShowFile showFile;           // or its .show file on the sd card
+  CueSource *cues = &cueTable; // whichever of the two the song uses
+  BeatMap beatMap;             // precomputed beats, if the song has a .beats file on the sd card
+  FrameCache frameCache;       // pre-rendered frames, if it has a .cache file on the sd card
+};
+SongFiles songFiles[2];
+SongFiles *current = &songFiles[0];  // the song that is playing
+SongFiles *upcoming = &songFiles[1]; // playlist.upcoming(), once upcomingReady
+bool upcomingReady = false;           // its files are open and its audio preloaded
+Playlist playlist;
+
+// the next song is opened this far into a song, so it doesn't hold up the first frames
+#define PRELOAD_AFTER_MS 1000
 
-void rainbowWithGlitter()
-{
-  // built-in FastLED rainbow, plus some random sparkly glitter
-  rainbow();
-  addGlitter(80);
-}
+uint8_t gCurrentPatternNumber = 3; // Index number of which pattern is current
 
-void addGlitter(fract8 chanceOfGlitter)
+// Jumps the playing song to position and rebuilds everything as if it had played up to
+// there: audio, beat map and the show (rebuildShow()). false, and nothing changed, when the
+// audio can't go there: past the end, or within LOOKAHEAD_MS of it
+static bool seekShow(uint32_t position)
 {
-  if (random8() < chanceOfGlitter)
+  if (position && !playSdWav1.seek(position + LOOKAHEAD_MS)) // audiblePositionMicros() == position
   {
-    leds[random16(NUM_LEDS)] += CRGB::White;
+    return false;
   }
+  current->beatMap.seek(position, beatDetector);
+  rebuildShow(*current->cues, position, frameScheduler.period());
+  current->frameCache.seek(position);
+  frameScheduler.reset(position * 1000);
+  return true;
 }
 
-void confetti()
+// Runs while the song before plays, see Sidecar.h for how that shares the sd card
+static void openSongFiles(SongFiles &files, uint8_t songNumber)
 {
-  // random colored speckles that blink in and fade smoothly
-  fadeToBlackBy(leds, NUM_LEDS, 10);
-  int pos = random16(NUM_LEDS);
-  leds[pos] += CHSV(gHue + random8(64), 200, 255);
-}
-
-void flashPulsing()
-{
-  CRGBPalette16 palette = PartyColors_p;
-  fadeToBlackBy(leds, NUM_LEDS, 8);
-  if (beatDetector.virtualBeat)
+  files.songNumber = songNumber;
+  const Song &song = gSongs[songNumber];
+  // a .show file on the sd card wins over the compiled in cues
+  if (files.showFile.open(song.filename))
   {
-    for (int i = 0; i < NUM_LEDS; i++)
-    {
-      leds[i] = CRGB::White;
-    }
+    files.cues = &files.showFile;
   }
-}
-
-void pulsing()
-{
-  CRGBPalette16 palette = PartyColors_p;
-  fadeToBlackBy(leds, NUM_LEDS, 1);
-  if (beatDetector.virtualBeat)
+  else
   {
-    for (int i = 0; i < NUM_LEDS; i++)
-    {
-      leds[i] = ColorFromPalette(palette, gHue + (i * 2), gHue + (i * 10));
-    }
+    files.cueTable = song.show ? CueTable(song.show->cues, song.show->count) : CueTable();
+    files.cues = &files.cueTable;
   }
+  files.frameCache.open(song.filename, frameCacheShowId(*files.cues));
+  files.beatMap.open(song.filename);
 }
 
-void singleFlashAT(uint32_t seconds, CRGB color)
+// the audio of current just started, the show starts at position
+static void beginShow(uint32_t position)
 {
-  AT(0, 0, seconds) { fill_solid(leds, NUM_LEDS, color); }
-  FROM(0, 0, seconds + 0.005) { fadeToBlackBy(leds, NUM_LEDS, 2); }
-}
-
-void bpm(uint8_t BeatsPerMinute)
-{
-  // colored stripes pulsing at a defined Beats-Per-Minute (BPM)
-  CRGBPalette16 palette = PartyColors_p;
-  uint8_t beat = beatsin8(BeatsPerMinute, 64, 255);
-  for (int i = 0; i < NUM_LEDS; i++)
+  gCurrentPatternNumber = current->songNumber;
+  Serial.println("Start playing");
+  // with a precomputed beat map there's no need to run the fft at all
+  if (current->beatMap.isOpen())
   {
-    leds[i] = ColorFromPalette(palette, gHue + (i * 2), beat - gHue + (i * 10));
+    patchCord5.disconnect();
   }
-}
-
-void fillGradual(uint8_t BeatsPerMinute) {
-  uint8_t beat = beatsin8(BeatsPerMinute, 0, NUM_LEDS);
-
-  CRGBPalette16 palette = PartyColors_p;
-  fill_solid(leds, NUM_LEDS, CRGB::Black);
-  for (int i = 0; i < NUM_LEDS; i++)
+  else
   {
-    if (i <= beat)
-    {
-      leds[i] = ColorFromPalette(palette, gHue, 120 + ((beat / NUM_LEDS) * 135));
-
-    }
+    patchCord5.connect();
   }
-}
-
-void wiggleLines(uint8_t BeatsPerMinute)
-{
-  int linelength = 10;
-  int moving_distance = 40;
-  int start_value = 30;
-  uint8_t beat = beatsin8(BeatsPerMinute, start_value, start_value + moving_distance);
-
-  CRGBPalette16 palette = PartyColors_p;
-  fill_solid(leds, NUM_LEDS, CRGB::Black);
-  for (int i = 0; i < 0.5 * NUM_LEDS; i++)
+  digitalWrite(WHITE_LED_PIN, LOW);
+  if (!seekShow(position))
   {
-    if ((beat - i) < linelength && (beat - i) > -linelength)
-    {
-      leds[i] = ColorFromPalette(palette, gHue, 255 - (10 * abs(beat - i)));
-      int otherIndex = (0.5 * NUM_LEDS) + i;
-      leds[otherIndex] = ColorFromPalette(palette, gHue, 255 - (10 * abs(beat - i)));
-    }
+    seekShow(0); // the audio is still at the start
   }
 }
 
-void flashAtBpm(uint8_t BeatsPerMinute, CHSV hsv)
+static void startSong(uint8_t songNumber, uint32_t position)
 {
-  // Everything pulsing at hue in beat
-  CRGBPalette16 palette = PartyColors_p;
-  fadeToBlackBy(leds, NUM_LEDS, 5);
-  uint8_t beat = beatsin8(BeatsPerMinute, 64, 255);
-  if (beat < 67)
-  {
-    for (int i = 0; i < NUM_LEDS; i++)
-    {
-      leds[i] = hsv;
-    }
-  }
+  button.armed = false;
+  openSongFiles(*current, songNumber);
+  playSdWav1.play(gSongs[songNumber].filename);
+  beginShow(position);
 }
 
-void flashSingle(const CRGB &color1, const CRGB &color2, const CRGB &color3, const CRGB &color4)
+// Opens the next song of the playlist ahead of time: its cues, beat map and frame cache,
+// and the start of its audio, so starting it later needs no sd card access.
+static void prepareUpcoming()
 {
-  uint8_t beat = beatsin8(3, 64, 255);
-  fadeToBlackBy(leds, NUM_LEDS, 5);
-  if (beat < 1)
+  if (!gNumberOfSongs)
   {
-    quarters(color1, color2, color3, color4);
+    return;
+  }
+  button.armed = false;
+  uint8_t songNumber = playlist.upcoming();
+  openSongFiles(*upcoming, songNumber);
+  upcomingReady = playSdWav1.preload(gSongs[songNumber].filename, playlist.upcomingQueued());
+  if (!upcomingReady)
+  {
+    playlist.advance(); // can't be played, the one after it then
   }
 }
 
-void juggle()
+static void printFrameStats()
 {
-  // eight colored dots, weaving in and out of sync with each other
-  fadeToBlackBy(leds, NUM_LEDS, 20);
-  byte dothue = 0;
-  for (int i = 0; i < 8; i++)
-  {
-    leds[beatsin16(i + 7, 0, NUM_LEDS)] |= CHSV(dothue, 200, 255);
-    dothue += 32;
-  }
+  Serial.printf("%u frames, %u dropped, %u late, %.1f fps on %d leds\n", frameScheduler.framesDrawn, frameScheduler.framesDropped,
+                frameScheduler.framesLate, frameScheduler.framesPerSecond(), NUM_LEDS);
 }
 
-// An animation to play while the crowd goes wild after the big performance
-void applause(uint8_t width)
+static bool wasPlaying = false;
+
+// the frame just sent out shows something, for the latency probe
+static bool anyLit()
 {
-  static uint16_t lastPixel = 0;
-  static uint8_t hue = random8(HUE_BLUE, HUE_PURPLE);
-  fadeToBlackBy(leds, NUM_LEDS, 32);
-  for (int i = 0; i <= width; i++)
+  if (!FastLED.getBrightness())
   {
-    leds[(lastPixel + i) % NUM_LEDS] = CHSV(hue, 255, 255);
-    leds[(lastPixel + NUM_LEDS - i) % NUM_LEDS] = CHSV(hue, 255, 255);
+    return false;
   }
-
-  lastPixel = random16(NUM_LEDS);
-  for (int i = 0; i <= width; i++)
+  for (int i = 0; i < NUM_LEDS; i++)
   {
-    leds[(lastPixel + i) % NUM_LEDS] = CRGB::White;
-    leds[(lastPixel + NUM_LEDS - i) % NUM_LEDS] = CRGB::White;
+    if (leds[i])
+    {
+      return true;
+    }
   }
+  return false;
 }
 
-// An "animation" to just fade to black.  Useful as the last track
-// in a non-looping performance.
-void fadeToBlack()
+// the preloaded song started, by the button or following the song before without a gap
+static void upcomingStarted()
 {
-  fadeToBlackBy(leds, NUM_LEDS, 1);
+  if (wasPlaying)
+  {
+    printFrameStats();
+  }
+  SongFiles *previous = current;
+  current = upcoming;
+  upcoming = previous;
+  upcomingReady = false;
+  playlist.advance();
+  latencyProbe.audioStarted(playSdWav1.startedMicros());
+  beginShow(0);
 }
 
-//////////////////////////
-void sinelon()
+// "m:ss.fff" or "ss.fff" like in the .cues files, ms
+static uint32_t parseTimecode(const char *text)
 {
-  // a colored dot sweeping back and forth, with fading trails
-  fadeToBlackBy(leds, NUM_LEDS, 12);
-  int pos = beatsin16(13, 0, NUM_LEDS - 1);
-  leds[pos] += CHSV(gHue, 255, 192);
+  const char *colon = strchr(text, ':');
+  double seconds = colon ? atoi(text) * 60 + atof(colon + 1) : atof(text);
+  return seconds > 0 ? (uint32_t)(seconds * 1000 + 0.5) : 0;
 }
 
-/////////////////////////
-void spew()
+// Serial commands to rehearse a show without playing it from the start:
+//   play N [TIME]  start song N (as listed at boot) at TIME
+//   seek TIME      jump to TIME in the song that is playing
+//   queue N        play song N next, right after the one that is playing
+//   latency        button press to audio and to light of the last presses
+static void readSerialCommands()
 {
-  const uint16_t spewSpeed = 100; // rate of advance
-  static boolean spewing = 0;     // pixels are On(1) or Off(0)
-  static uint8_t count = 1;       // how many to light (or not light)
-  static uint8_t temp = count;
-  static uint8_t hue = random8();
-  EVERY_N_MILLISECONDS(spewSpeed)
+  static char line[32];
+  static uint8_t length = 0;
+  while (Serial.available())
   {
-    if (count == 0)
+    char c = Serial.read();
+    if (c != '\n' && c != '\r')
     {
-      spewing = !spewing;
-      if (spewing == 1)
-      {
-        count = random8(2, 5);
-      } // random number for On pixels
-      else
+      if (length < sizeof(line) - 1)
       {
-        count = random8(1, 8);
-      } // random number for Off pixels
-      temp = count;
-      // gHue = gHue - 30;
-      hue = random8();
+        line[length++] = c;
+      }
+      continue;
     }
-    for (uint8_t i = NUM_LEDS - 1; i > 0; i--)
+    line[length] = 0;
+    length = 0;
+
+    char *argument = strchr(line, ' ');
+    argument = argument ? argument + 1 : line + strlen(line);
+    if (!strncmp(line, "seek ", 5) && playSdWav1.isPlaying())
     {
-      leds[i] = leds[i - 1]; // shift data down the line by one pixel
-    }
-    if (spewing == 1)
-    { // new pixels are On
-      if (temp == count)
+      if (!seekShow(parseTimecode(argument)))
       {
-        leds[0] = CHSV(hue - 5, 215, 255); // for first dot
-        // leds[0] = CHSV(gHue-5, 215, 255);  // for first dot
+        Serial.println("Past the end of the song");
       }
-      else
+    }
+    else if (!strncmp(line, "play ", 5))
+    {
+      uint8_t songNumber = atoi(argument);
+      const char *time = strchr(argument, ' ');
+      if (songNumber < gNumberOfSongs)
       {
-        leds[0] = CHSV(hue, 255, 255 / (1 + ((temp - count) * 2))); // for following dots
-        // leds[0] = CHSV(gHue, 255, 255/(1+((temp-count)*2)) );  // for following dots
+        startSong(songNumber, time ? parseTimecode(time + 1) : 0);
       }
     }
-    else
-    {                          // new pixels are Off
-      leds[0] = CHSV(0, 0, 0); // set pixel 0 to black
+    else if (!strncmp(line, "queue ", 6) && playlist.queue(atoi(argument)))
+    {
+      // open it instead of whatever was going to come next
+      button.armed = false;
+      playSdWav1.cancelPreload();
+      upcomingReady = false;
     }
-    count = count - 1; // reduce count by one.
-  }                    // end every_n
-} // end spew
-
-//////////////////////////
-void spewFour()
-{
-  // Similar to the abouve "spew", but split up into four sections,
-  // specifically designed for a 8x4 matrix with Z-layout.
-  const uint16_t spewSpeed = 100;           // rate of advance
-  static uint8_t spewing[4] = {0, 0, 0, 0}; // pixels are On(1) or Off(0)
-  static uint8_t count[4] = {1, 1, 1, 1};   // how many to light (or not light)
-  static uint8_t temp[4] = {count[0], count[1], count[2], count[3]};
-  static uint8_t hue[4] = {random8(), random8(), random8(), random8()};
-  EVERY_N_MILLISECONDS(spewSpeed)
-  {
-    for (uint8_t j = 0; j < 4; j++)
+    else if (!strcmp(line, "latency"))
     {
-      if (count[j] == 0)
-      {
-        if (spewing[j] == 0)
-        {
-          spewing[j] = 1;
-        }
-        else
-        {
-          spewing[j] = 0;
-        }
-        if (spewing[j] == 1)
-        {
-          count[j] = random8(2, 5);
-        } // random number for On pixels
-        else
-        {
-          count[j] = random8(1, 8);
-        } // random number for Off pixels
-        temp[j] = count[j];
-        EVERY_N_SECONDS(2)
-        { // hue going across is constant for awhile
-          hue[j] = random8();
-        }
-      }
-      for (uint8_t i = 7; i > 0; i--)
-      {
-        leds[(j * 8) + i] = leds[(j * 8) + i - 1]; // shift data down the line by one pixel
-      }
-      if (spewing[j] == 1)
-      { // new pixels are On
-        if (temp[j] == count[j])
-        {
-          leds[((j + 1) * 8) - 8] = CHSV(hue[j] - 5, 215, 255); // for first dot
-        }
-        else
-        {
-          leds[((j + 1) * 8) - 8] = CHSV(hue[j], 255, 255 / (1 + ((temp[j] - count[j]) * 2))); // for following dots
-        }
-      }
-      else
-      {                                          // new pixels are Off
-        leds[((j + 1) * 8) - 8] = CHSV(0, 0, 0); // set pixel 0 to black
-      }
-      count[j] = count[j] - 1; // reduce count by one.
-    }                          // end for loop
-  }                            // end every_n
-} // end spewFour
+      latencyProbe.report(Serial);
+    }
+  }
+}
 
-//////////////////////////
-void blinkyblink1()
+void loop()
 {
-  static boolean dataIncoming = LOW;
-  static boolean blinkGate1 = LOW;
-  static boolean blinkGate2 = HIGH;
-  static int8_t count = -1;
+  // FastLED.show() doesn't wait for the wire, a frame that couldn't go out yet goes now
+  pcontroller->present();
+  readSerialCommands();
 
-  EVERY_N_MILLISECONDS_I(timingObj, 250)
+  uint32_t pressedMicros;
+  bool songStarted;
+  if (button.takePress(pressedMicros, songStarted))
   {
-    count++;
-    if (count == 6)
-    {
-      count = 0;
-    }
-    blinkGate2 = count;
-    dataIncoming = !dataIncoming;
-    blinkGate1 = !blinkGate1;
-    // Serial.print("c: "); Serial.print(count); Serial.print("\t");
-    // Serial.print(dataIncoming); Serial.print("  "); Serial.print(blinkGate1);
-    // Serial.print("\t"); Serial.print(dataIncoming * blinkGate1 * 255 * blinkGate2);
-    // Serial.print("\tb: "); Serial.print(blinkGate2); Serial.println(" ");
-    FastLED.clear();
-    leds[0] = CHSV(gHue, 0, dataIncoming * blinkGate1 * 255 * blinkGate2);
-    if (count == 2 || count == 3)
-    {
-      timingObj.setPeriod(50);
-    }
-    else if (count == 4)
+    digitalWrite(WHITE_LED_PIN, LOW);
+
+    if (!songStarted && playSdWav1.isPlaying() == false)
     {
-      timingObj.setPeriod(405);
+      // the interrupt couldn't start it, the next song of the playlist wasn't open yet
+      if (!upcomingReady)
+      {
+        prepareUpcoming();
+      }
+      songStarted = playSdWav1.playPreloaded();
     }
-    else
+    if (songStarted)
     {
-      timingObj.setPeriod(165);
+      latencyProbe.pressed(pressedMicros);
     }
   }
-} // end_blinkyblink1
-
-//////////////////////////
-void blinkyblink2()
-{
-  static boolean dataIncoming = LOW;
-  static boolean blinkGate1 = LOW;
-  static boolean blinkGate2 = HIGH;
-  static int8_t count = -1;
-  static int8_t P;
 
-  EVERY_N_MILLISECONDS_I(timingObj, 250)
+  static uint16_t preloadsStarted = 0;
+  if (playSdWav1.preloadsStarted() != preloadsStarted)
   {
-    count++;
-    if (count == 8)
+    // the interrupt can start the song after the takePress() above, the press goes to the
+    // probe before the song start does. any other press now is for a song that is playing
+    if (button.takePress(pressedMicros, songStarted) && songStarted)
     {
-      count = 0;
-      P = random8(NUM_LEDS);
+      latencyProbe.pressed(pressedMicros);
     }
-    blinkGate2 = count;
-    dataIncoming = !dataIncoming;
-    blinkGate1 = !blinkGate1;
-    // Serial.print("c: "); Serial.print(count); Serial.print("\t");
-    // Serial.print(dataIncoming); Serial.print("  "); Serial.print(blinkGate1);
-    // Serial.print("\t"); Serial.print(dataIncoming * blinkGate1 * 255 * blinkGate2);
-    // Serial.print("\tb: "); Serial.print(blinkGate2); Serial.println(" ");
-    FastLED.clear();
-    leds[P] = CHSV(gHue, 255, dataIncoming * blinkGate1 * 255 * blinkGate2);
-    if (count == 6)
+    preloadsStarted = playSdWav1.preloadsStarted();
+    upcomingStarted();
+  }
+
+  if (playSdWav1.isPlaying())
+  {
+    lastPlayingPosition = playSdWav1.positionMicros();
+    lastPlayingMicros = micros();
+  }
+  if (playSdWav1.isPlaying() || (wasPlaying && songStillAudible()))
+  {
+    wasPlaying = true;
+    uint32_t audio = audiblePositionMicros();
+    if (!frameScheduler.due(audio))
     {
-      timingObj.setPeriod(250);
+      return;
     }
-    else if (count == 7)
+    // once per frame, everything below works from this: the song position the frame will be seen at
+    uint32_t position = frameScheduler.beginFrame(audio) / 1000;
+    if (current->beatMap.isOpen())
     {
-      timingObj.setPeriod(500);
+      current->beatMap.update(position, beatDetector);
     }
     else
     {
-      timingObj.setPeriod(25);
+      beatDetector.BeatDetectorLoop();
     }
-  }
-} // end_blinkyblink2
 
-//////////////////////////
-void fillAndCC()
-{
-  static int16_t pos = 0;  // position along strip
-  static int8_t delta = 3; // delta (can be negative, and/or odd numbers)
-  static uint8_t hue = 0;  // hue to display
-  EVERY_N_MILLISECONDS(50)
-  {
-    leds[pos] = CHSV(hue, 255, 255);
-    pos = (pos + delta + NUM_LEDS) % NUM_LEDS;
-    if (delta >= 0 && pos == 0)
-    { // going forward
-      hue = hue + random8(42, 128);
+    renderFrame(position, runCue, current->frameCache.frameAt(position));
+
+    // send the 'leds' array out to the actual LED strip
+    FastLED.show();
+    frameScheduler.endFrame(audiblePositionMicros(), outputMicros());
+    if (latencyProbe.waitingForLight() && anyLit())
+    {
+      latencyProbe.lit(pcontroller->visibleMicros());
     }
-    if (delta < 0 && pos == NUM_LEDS - 1)
-    { // going backward
-      hue = hue + random8(42, 128);
+    // beat detection telemetry, only if beatDetector.enableSerialBeatDisplay is set. never waits for Serial
+    beatDetector.sendTelemetry();
+
+    if (!upcomingReady && position >= PRELOAD_AFTER_MS)
+    {
+      prepareUpcoming();
     }
   }
-} // fillAndCC
-
-//////////////////////////
-void twoDots()
-{
-  static uint8_t pos; // used to keep track of position
-  EVERY_N_MILLISECONDS(70)
+  else
   {
-    fadeToBlackBy(leds, NUM_LEDS, 200); // fade all the pixels some
-    leds[pos] = CHSV(gHue, random8(170, 230), 255);
-    leds[(pos + 5) % NUM_LEDS] = CHSV(gHue + 64, random8(170, 230), 255);
-    pos = pos + 1; // advance position
-
-    // This following check is very important.  Do not go past the last pixel!
-    if (pos == NUM_LEDS)
+    if (wasPlaying)
+    {
+      wasPlaying = false;
+      printFrameStats();
+    }
+    if (!upcomingReady)
     {
-      pos = 0;
-    } // reset to beginning
-    // Trying to write data to non-existent pixels causes bad things.
+      prepareUpcoming();
+    }
+    button.armed = upcomingReady;
+    FastLED.setBrightness(0);
+    FastLED.show();
+    digitalWrite(WHITE_LED_PIN, HIGH);
   }
-} // end_twoDots
\ No newline at end of file
+}
@@ -0,0 +1,176 @@
+/*
+ * FrameCache against CacheWriter (src/host/FrameCacheWriter.h): what render -C encodes is
+ * what the teensy decodes, frame for frame, however the song moves through it.
+ *
+ * The cache has two spans, frames 10 to 59 and 100 to 139 on a 120 fps grid. The frames
+ * have every kind of run in them: the background stays for 4 frames (KEEP), one stretch
+ * changes every frame (COPY) and the rest is one colour (FILL).
+ */
+
+#include <unity.h>
+#include "FrameCache.h"
+#include "FrameCacheWriter.h"
+
+static const uint32_t FRAME_PERIOD = 1000000 / 120;
+static const uint32_t SHOW_ID = 0x5eed1234;
+static const uint32_t FRAMES = 160;
+
+static CRGB expected[FRAMES][NUM_LEDS];
+static FrameCache cache;
+
+static bool inCache(uint32_t frame)
+{
+    return (frame >= 10 && frame < 60) || (frame >= 100 && frame < 140);
+}
+
+// the song position of frame, the way the renderer and loop() ask for it
+static uint32_t millisOf(uint32_t frame)
+{
+    return (uint64_t)frame * FRAME_PERIOD / 1000;
+}
+
+static void drawFrame(uint32_t frame, CRGB *leds)
+{
+    fill_solid(leds, NUM_LEDS, CRGB(frame / 4, 0, 40));
+    for (int i = 0; i < 20; i++)
+    {
+        leds[30 + i] = CRGB(i * 10, frame, 255 - i);
+    }
+    leds[(frame * 3) % NUM_LEDS] = CRGB::White;
+}
+
+static std::vector<uint8_t> &cacheFile()
+{
+    return host::sdFiles()["song.cache"];
+}
+
+void setUp()
+{
+    host::sdFiles().clear();
+    CacheWriter writer;
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        drawFrame(frame, expected[frame]);
+        if (inCache(frame))
+        {
+            writer.add(frame, expected[frame]);
+        }
+    }
+    cacheFile() = writer.file(FRAME_PERIOD, SHOW_ID);
+}
+
+void tearDown()
+{
+    cache.close();
+}
+
+static void test_every_frame_comes_back()
+{
+    TEST_ASSERT_TRUE(cache.open("song.wav", SHOW_ID));
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        const CRGB *got = cache.frameAt(millisOf(frame));
+        if (inCache(frame))
+        {
+            TEST_ASSERT_NOT_NULL(got);
+            TEST_ASSERT_EQUAL_MEMORY(expected[frame], got, sizeof(CRGB) * NUM_LEDS);
+        }
+        else
+        {
+            TEST_ASSERT_NULL(got);
+        }
+    }
+}
+
+// loop() misses frames when it runs late, the ones after still build on them
+static void test_dropped_frames_are_still_decoded()
+{
+    TEST_ASSERT_TRUE(cache.open("song.wav", SHOW_ID));
+    for (uint32_t frame = 0; frame < FRAMES; frame += 7)
+    {
+        const CRGB *got = cache.frameAt(millisOf(frame));
+        TEST_ASSERT_EQUAL(inCache(frame), got != nullptr);
+        if (got)
+        {
+            TEST_ASSERT_EQUAL_MEMORY(expected[frame], got, sizeof(CRGB) * NUM_LEDS);
+        }
+    }
+}
+
+// a span can only be played from its first frame
+static void test_seek_into_a_span_waits_for_the_next()
+{
+    TEST_ASSERT_TRUE(cache.open("song.wav", SHOW_ID));
+    cache.seek(millisOf(20));
+    for (uint32_t frame = 20; frame < 100; frame++)
+    {
+        TEST_ASSERT_NULL(cache.frameAt(millisOf(frame)));
+    }
+    for (uint32_t frame = 100; frame < 140; frame++)
+    {
+        const CRGB *got = cache.frameAt(millisOf(frame));
+        TEST_ASSERT_NOT_NULL(got);
+        TEST_ASSERT_EQUAL_MEMORY(expected[frame], got, sizeof(CRGB) * NUM_LEDS);
+    }
+}
+
+static void test_seek_back_to_a_span_start()
+{
+    TEST_ASSERT_TRUE(cache.open("song.wav", SHOW_ID));
+    TEST_ASSERT_NOT_NULL(cache.frameAt(millisOf(120)));
+    cache.seek(millisOf(10));
+    const CRGB *got = cache.frameAt(millisOf(10));
+    TEST_ASSERT_NOT_NULL(got);
+    TEST_ASSERT_EQUAL_MEMORY(expected[10], got, sizeof(CRGB) * NUM_LEDS);
+}
+
+static void test_no_cache_on_the_card()
+{
+    host::sdFiles().clear();
+    TEST_ASSERT_FALSE(cache.open("song.wav", SHOW_ID));
+    TEST_ASSERT_NULL(cache.frameAt(millisOf(10)));
+}
+
+static void test_cache_of_other_cues_is_turned_down()
+{
+    TEST_ASSERT_FALSE(cache.open("song.wav", SHOW_ID + 1));
+    TEST_ASSERT_FALSE(cache.isOpen());
+}
+
+static void test_other_version_or_led_count_is_turned_down()
+{
+    FrameCacheHeader header;
+    memcpy(&header, cacheFile().data(), sizeof(header));
+    header.version = FRAMECACHE_VERSION - 1;
+    memcpy(cacheFile().data(), &header, sizeof(header));
+    TEST_ASSERT_FALSE(cache.open("song.wav", SHOW_ID));
+
+    header.version = FRAMECACHE_VERSION;
+    header.ledCount = NUM_LEDS + 1;
+    memcpy(cacheFile().data(), &header, sizeof(header));
+    TEST_ASSERT_FALSE(cache.open("song.wav", SHOW_ID));
+}
+
+// the show is drawn without it from there on
+static void test_cut_off_cache_is_dropped()
+{
+    cacheFile().resize(cacheFile().size() - 10);
+    TEST_ASSERT_TRUE(cache.open("song.wav", SHOW_ID));
+    TEST_ASSERT_NOT_NULL(cache.frameAt(millisOf(10)));
+    TEST_ASSERT_NULL(cache.frameAt(millisOf(139)));
+    TEST_ASSERT_FALSE(cache.isOpen());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_frame_comes_back);
+    RUN_TEST(test_dropped_frames_are_still_decoded);
+    RUN_TEST(test_seek_into_a_span_waits_for_the_next);
+    RUN_TEST(test_seek_back_to_a_span_start);
+    RUN_TEST(test_no_cache_on_the_card);
+    RUN_TEST(test_cache_of_other_cues_is_turned_down);
+    RUN_TEST(test_other_version_or_led_count_is_turned_down);
+    RUN_TEST(test_cut_off_cache_is_dropped);
+    return UNITY_END();
+}
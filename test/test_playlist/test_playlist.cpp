@@ -0,0 +1,114 @@
+/*
+ * Playlist: the shuffle rounds and the queue (src/Playlist.h).
+ */
+
+#include <unity.h>
+#include "Playlist.h"
+
+static Playlist playlist;
+
+void setUp()
+{
+    host::setMicros(0);
+    playlist = Playlist();
+}
+
+void tearDown()
+{
+}
+
+// plays rounds of songs songs, the way loop() does: upcoming() starts, then advance(). only
+// MAX_SONGS of them fit
+static void checkRounds(uint8_t songs, int rounds)
+{
+    playlist.begin(songs);
+    songs = songs < Playlist::MAX_SONGS ? songs : Playlist::MAX_SONGS;
+    int last = -1;
+    for (int round = 0; round < rounds; round++)
+    {
+        bool played[Playlist::MAX_SONGS] = {};
+        for (int i = 0; i < songs; i++)
+        {
+            uint8_t song = playlist.upcoming();
+            TEST_ASSERT_TRUE(song < songs);
+            TEST_ASSERT_FALSE(played[song]); // every song once before any comes twice
+            if (i == 0 && songs > 1)
+            {
+                TEST_ASSERT_NOT_EQUAL(last, song); // the last of a round never starts the next
+            }
+            played[song] = true;
+            last = song;
+            host::setMicros(micros() + 180000000 + 1234567 * song); // it plays for a while
+            playlist.advance();
+        }
+    }
+}
+
+static void test_every_song_once_a_round()
+{
+    checkRounds(7, 50);
+}
+
+static void test_two_songs_take_turns()
+{
+    checkRounds(2, 20);
+}
+
+static void test_one_song_over_and_over()
+{
+    playlist.begin(1);
+    for (int i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_EQUAL(0, playlist.upcoming());
+        playlist.advance();
+    }
+}
+
+static void test_more_songs_than_fit()
+{
+    checkRounds(Playlist::MAX_SONGS + 8, 3);
+}
+
+// the shuffled order picks up where it was after them
+static void test_queued_songs_come_first_in_order()
+{
+    playlist.begin(5);
+    uint8_t shuffled = playlist.upcoming();
+    TEST_ASSERT_FALSE(playlist.upcomingQueued());
+
+    TEST_ASSERT_TRUE(playlist.queue(3));
+    TEST_ASSERT_TRUE(playlist.queue(1));
+    TEST_ASSERT_TRUE(playlist.upcomingQueued());
+    TEST_ASSERT_EQUAL(3, playlist.upcoming());
+    playlist.advance();
+    TEST_ASSERT_TRUE(playlist.upcomingQueued());
+    TEST_ASSERT_EQUAL(1, playlist.upcoming());
+    playlist.advance();
+    TEST_ASSERT_FALSE(playlist.upcomingQueued());
+    TEST_ASSERT_EQUAL(shuffled, playlist.upcoming());
+}
+
+static void test_queue_turns_down_what_it_cant_play()
+{
+    playlist.begin(5);
+    TEST_ASSERT_FALSE(playlist.queue(5));
+    for (int i = 0; i < Playlist::MAX_QUEUED; i++)
+    {
+        TEST_ASSERT_TRUE(playlist.queue(i % 5));
+    }
+    TEST_ASSERT_FALSE(playlist.queue(0));
+    playlist.advance();
+    TEST_ASSERT_TRUE(playlist.queue(0));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_song_once_a_round);
+    RUN_TEST(test_two_songs_take_turns);
+    RUN_TEST(test_one_song_over_and_over);
+    RUN_TEST(test_more_songs_than_fit);
+    RUN_TEST(test_queued_songs_come_first_in_order);
+    RUN_TEST(test_queue_turns_down_what_it_cant_play);
+    return UNITY_END();
+}
@@ -0,0 +1,256 @@
+/*
+ * WavPlayer on an sd card in memory (src/host/SD.h), update() called by hand in place of
+ * the audio interrupt: playing, seeking into and out of the preloaded frames, and the
+ * join from one song into the next that follows it.
+ *
+ * The test songs count: left is base + i at frame i, right the negative of that, so every
+ * sample that goes out says which song and frame it came from.
+ */
+
+#include <unity.h>
+#include <vector>
+#include "WavPlayer.h"
+
+static WavPlayer *player; // a new one for every test
+
+static int16_t left(int16_t base, uint32_t frame) { return base + frame; }
+static int16_t right(int16_t base, uint32_t frame) { return -left(base, frame); }
+
+static void put32(std::vector<uint8_t> &bytes, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        bytes.push_back(value >> (8 * i));
+    }
+}
+
+static void put16(std::vector<uint8_t> &bytes, uint16_t value)
+{
+    bytes.push_back(value);
+    bytes.push_back(value >> 8);
+}
+
+// a 16 bit 44.1 kHz wav with a LIST chunk of odd size before the data, like some editors write
+static void putWav(const char *name, uint32_t frames, uint16_t channels, int16_t base, uint16_t bits = 16)
+{
+    std::vector<uint8_t> bytes;
+    uint32_t dataSize = frames * 2 * channels;
+    bytes.insert(bytes.end(), {'R', 'I', 'F', 'F'});
+    put32(bytes, 4 + 8 + 16 + 8 + 6 + 8 + dataSize);
+    bytes.insert(bytes.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    put32(bytes, 16);
+    put16(bytes, 1);
+    put16(bytes, channels);
+    put32(bytes, 44100);
+    put32(bytes, 44100 * 2 * channels);
+    put16(bytes, 2 * channels);
+    put16(bytes, bits);
+    bytes.insert(bytes.end(), {'L', 'I', 'S', 'T'});
+    put32(bytes, 5);
+    bytes.insert(bytes.end(), {'I', 'N', 'F', 'O', 0, 0});
+    bytes.insert(bytes.end(), {'d', 'a', 't', 'a'});
+    put32(bytes, dataSize);
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        put16(bytes, left(base, frame));
+        if (channels == 2)
+        {
+            put16(bytes, right(base, frame));
+        }
+    }
+    host::sdFiles()[name] = bytes;
+}
+
+// the next count blocks, left and right
+static void playBlocks(int count, std::vector<int16_t> &l, std::vector<int16_t> &r)
+{
+    for (int i = 0; i < count; i++)
+    {
+        player->update();
+        l.insert(l.end(), player->output(0), player->output(0) + AUDIO_BLOCK_SAMPLES);
+        r.insert(r.end(), player->output(1), player->output(1) + AUDIO_BLOCK_SAMPLES);
+    }
+}
+
+// count blocks go out as song base from frame on
+static void checkBlocks(int count, int16_t base, uint32_t frame)
+{
+    std::vector<int16_t> l, r;
+    playBlocks(count, l, r);
+    for (size_t i = 0; i < l.size(); i++)
+    {
+        TEST_ASSERT_EQUAL(left(base, frame + i), l[i]);
+        TEST_ASSERT_EQUAL(right(base, frame + i), r[i]);
+    }
+}
+
+static uint32_t frameOf(uint32_t millis)
+{
+    return (uint64_t)millis * 44100 / 1000;
+}
+
+void setUp()
+{
+    host::sdFiles().clear();
+    host::setMicros(0);
+    player = new WavPlayer;
+    putWav("a.wav", 1000, 2, 0);      // 7 blocks and 104 frames
+    putWav("b.wav", 3000, 2, 10000);
+}
+
+void tearDown()
+{
+    delete player;
+}
+
+static void test_plays_from_the_start()
+{
+    TEST_ASSERT_TRUE(player->play("b.wav"));
+    TEST_ASSERT_EQUAL(3000 * 1000 / 44100, player->lengthMillis());
+    checkBlocks(10, 10000, 0);
+    TEST_ASSERT_EQUAL(10 * AUDIO_BLOCK_SAMPLES * 1000 / 44100, player->positionMillis());
+}
+
+static void test_plays_from_a_position()
+{
+    TEST_ASSERT_TRUE(player->play("b.wav", 30));
+    checkBlocks(4, 10000, frameOf(30));
+}
+
+static void test_mono_goes_out_on_both()
+{
+    putWav("mono.wav", 500, 1, 100);
+    TEST_ASSERT_TRUE(player->play("mono.wav"));
+    std::vector<int16_t> l, r;
+    playBlocks(2, l, r);
+    for (size_t i = 0; i < l.size(); i++)
+    {
+        TEST_ASSERT_EQUAL(left(100, i), l[i]);
+        TEST_ASSERT_EQUAL(left(100, i), r[i]);
+    }
+}
+
+static void test_only_16_bit_wavs()
+{
+    putWav("8bit.wav", 500, 2, 0, 8);
+    TEST_ASSERT_FALSE(player->play("8bit.wav"));
+    TEST_ASSERT_FALSE(player->play("missing.wav"));
+    TEST_ASSERT_FALSE(player->isPlaying());
+}
+
+// the end of the last block is silence
+static void test_song_ends()
+{
+    TEST_ASSERT_TRUE(player->play("a.wav"));
+    std::vector<int16_t> l, r;
+    playBlocks(8, l, r);
+    for (size_t i = 0; i < l.size(); i++)
+    {
+        TEST_ASSERT_EQUAL(i < 1000 ? left(0, i) : 0, l[i]);
+    }
+    TEST_ASSERT_FALSE(player->isPlaying());
+    TEST_ASSERT_FALSE(player->seek(0));
+}
+
+static void test_seek_past_the_end_fails()
+{
+    TEST_ASSERT_TRUE(player->play("b.wav"));
+    checkBlocks(2, 10000, 0);
+    TEST_ASSERT_FALSE(player->seek(player->lengthMillis() + 1));
+    checkBlocks(2, 10000, 2 * AUDIO_BLOCK_SAMPLES); // carries on where it was
+}
+
+// frames 0 to PRELOAD_FRAMES come from RAM and the file goes on after them, whichever way
+// the seek went
+static void test_seek_within_the_preloaded_frames()
+{
+    TEST_ASSERT_TRUE(player->play("a.wav"));
+    TEST_ASSERT_TRUE(player->preload("b.wav", false));
+    TEST_ASSERT_TRUE(player->playPreloaded());
+
+    TEST_ASSERT_TRUE(player->seek(5));
+    checkBlocks(10, 10000, frameOf(5)); // on past PRELOAD_FRAMES into the file
+
+    TEST_ASSERT_TRUE(player->seek(15));
+    checkBlocks(3, 10000, frameOf(15)); // back into them
+
+    TEST_ASSERT_TRUE(player->seek(50));
+    checkBlocks(3, 10000, frameOf(50)); // past them
+
+    TEST_ASSERT_TRUE(player->seek(0));
+    checkBlocks(10, 10000, 0);
+}
+
+static void test_play_preloaded_starts_it_from_the_start()
+{
+    TEST_ASSERT_TRUE(player->play("a.wav"));
+    checkBlocks(2, 0, 0);
+    TEST_ASSERT_TRUE(player->preload("b.wav", false));
+    TEST_ASSERT_TRUE(player->isPreloaded());
+    host::setMicros(5000);
+    TEST_ASSERT_TRUE(player->playPreloaded());
+    TEST_ASSERT_FALSE(player->isPreloaded());
+    TEST_ASSERT_EQUAL(1, player->preloadsStarted());
+    TEST_ASSERT_EQUAL(5000, player->startedMicros());
+    checkBlocks(10, 10000, 0);
+    TEST_ASSERT_FALSE(player->playPreloaded());
+}
+
+// the next song goes on in the middle of the block the one before ends in
+static void test_follow_joins_sample_for_sample()
+{
+    TEST_ASSERT_TRUE(player->play("a.wav"));
+    TEST_ASSERT_TRUE(player->preload("b.wav", true));
+    std::vector<int16_t> l, r;
+    playBlocks(12, l, r);
+    for (size_t i = 0; i < l.size(); i++)
+    {
+        TEST_ASSERT_EQUAL(i < 1000 ? left(0, i) : left(10000, i - 1000), l[i]);
+        TEST_ASSERT_EQUAL(i < 1000 ? right(0, i) : right(10000, i - 1000), r[i]);
+    }
+    TEST_ASSERT_TRUE(player->isPlaying());
+    TEST_ASSERT_EQUAL(1, player->preloadsStarted());
+    TEST_ASSERT_EQUAL((12 * AUDIO_BLOCK_SAMPLES - 1000) * 1000 / 44100, player->positionMillis());
+}
+
+// without follow the preloaded song waits for playPreloaded()
+static void test_no_follow_waits()
+{
+    TEST_ASSERT_TRUE(player->play("a.wav"));
+    TEST_ASSERT_TRUE(player->preload("b.wav", false));
+    std::vector<int16_t> l, r;
+    playBlocks(9, l, r);
+    TEST_ASSERT_FALSE(player->isPlaying());
+    TEST_ASSERT_EQUAL(0, l.back());
+    TEST_ASSERT_TRUE(player->isPreloaded());
+    TEST_ASSERT_TRUE(player->playPreloaded());
+    checkBlocks(2, 10000, 0);
+}
+
+static void test_cancelled_preload_doesnt_follow()
+{
+    TEST_ASSERT_TRUE(player->play("a.wav"));
+    TEST_ASSERT_TRUE(player->preload("b.wav", true));
+    player->cancelPreload();
+    std::vector<int16_t> l, r;
+    playBlocks(9, l, r);
+    TEST_ASSERT_FALSE(player->isPlaying());
+    TEST_ASSERT_EQUAL(0, player->preloadsStarted());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_plays_from_the_start);
+    RUN_TEST(test_plays_from_a_position);
+    RUN_TEST(test_mono_goes_out_on_both);
+    RUN_TEST(test_only_16_bit_wavs);
+    RUN_TEST(test_song_ends);
+    RUN_TEST(test_seek_past_the_end_fails);
+    RUN_TEST(test_seek_within_the_preloaded_frames);
+    RUN_TEST(test_play_preloaded_starts_it_from_the_start);
+    RUN_TEST(test_follow_joins_sample_for_sample);
+    RUN_TEST(test_no_follow_waits);
+    RUN_TEST(test_cancelled_preload_doesnt_follow);
+    return UNITY_END();
+}
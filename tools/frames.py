@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""
+Looks at .frames files from the host show renderer (src/host/render.cpp, src/FrameFileFormat.h).
+
+Prints what is in a render, turns it into a png strip with one row of pixels per frame
+(time going down, the leds across, brightness applied like the strip does), or compares
+two renders frame by frame, for checking that a firmware change didn't change a show.
+Frame caches (render.cpp -C, src/FrameCacheFormat.h) can be looked at and compared the
+same way, they only have the cached frames and no brightness.
+
+    tools/frames.py astro.frames
+    tools/frames.py astro.frames --png astro.png --scale 4
+    tools/frames.py before.frames --diff after.frames
+    tools/frames.py astro.cache --diff astro.frames
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = b"LEDF"
+VERSION = 1
+FILE_HEADER = struct.Struct("<4sHHII")
+FRAME_HEADER = struct.Struct("<IB3x")
+
+CACHE_MAGIC = b"LEDC"
+CACHE_VERSION = 1
+CACHE_HEADER = struct.Struct("<4sHHIII")
+CACHE_SPAN = struct.Struct("<III")
+KEEP, FILL, COPY = 0x00, 0x40, 0x80
+
+
+def read_cache(data, path):
+    """frame cache -> (header dict, [(time, None, rgb bytes)]) like read_frames"""
+    magic, version, led_count, period, _, span_count = CACHE_HEADER.unpack_from(data)
+    if version != CACHE_VERSION:
+        raise ValueError(path + " is not a frame cache this knows")
+    frames = []
+    offset = CACHE_HEADER.size
+    for _ in range(span_count):
+        first, count, size = CACHE_SPAN.unpack_from(data, offset)
+        offset += CACHE_SPAN.size
+        end = offset + size
+        rgb = bytearray(3 * led_count)
+        for frame in range(first, first + count):
+            led = 0
+            while led < led_count:
+                run = data[offset]
+                length = (run & 0x3F) + 1
+                offset += 1
+                if run & 0xC0 == FILL:
+                    rgb[3 * led:3 * (led + length)] = data[offset:offset + 3] * length
+                    offset += 3
+                elif run & 0xC0 == COPY:
+                    rgb[3 * led:3 * (led + length)] = data[offset:offset + 3 * length]
+                    offset += 3 * length
+                elif run & 0xC0 != KEEP or frame == first:
+                    raise ValueError(path + " is broken")
+                led += length
+            frames.append((frame * period // 1000, None, bytes(rgb)))
+        if offset != end:
+            raise ValueError(path + " is broken")
+    return {"leds": led_count, "period": period, "frames": len(frames), "spans": span_count, "bytes": len(data)}, frames
+
+
+def read_frames(path):
+    """-> (file header dict, [(time, brightness, rgb bytes)]), brightness is None for a cache"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] == CACHE_MAGIC:
+        return read_cache(data, path)
+    magic, version, led_count, period, frame_count = FILE_HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(path + " is not a frame file")
+    frames = []
+    offset = FILE_HEADER.size
+    size = FRAME_HEADER.size + 3 * led_count
+    for _ in range(frame_count):
+        if offset + size > len(data):
+            raise ValueError(path + " is cut short")
+        time, brightness = FRAME_HEADER.unpack_from(data, offset)
+        frames.append((time, brightness, data[offset + FRAME_HEADER.size:offset + size]))
+        offset += size
+    return {"leds": led_count, "period": period, "frames": frame_count}, frames
+
+
+def write_png(path, width, rows):
+    """rows of width * 3 rgb bytes"""
+    def chunk(kind, body):
+        return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", zlib.crc32(kind + body) & 0xFFFFFFFF)
+
+    raw = b"".join(b"\x00" + row for row in rows)
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, len(rows), 8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(raw, 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+def shown(rgb, brightness):
+    """what the strip shows: FastLED scales every channel by the brightness"""
+    if brightness is None:
+        return rgb
+    return bytes((c * (brightness + 1)) >> 8 for c in rgb)
+
+
+def png_strip(header, frames, path, scale):
+    rows = []
+    for _, brightness, rgb in frames:
+        row = shown(rgb, brightness)
+        if scale > 1:
+            row = b"".join(row[i:i + 3] * scale for i in range(0, len(row), 3))
+        rows.extend([row] * scale)
+    write_png(path, header["leds"] * scale, rows)
+    print("{}: {} x {} pixels".format(path, header["leds"] * scale, len(rows)))
+
+
+def diff(a_path, b_path):
+    a_header, a = read_frames(a_path)
+    b_header, b = read_frames(b_path)
+    if a_header["leds"] != b_header["leds"] or a_header["period"] != b_header["period"]:
+        print("different led count or frame period, can't compare")
+        return 1
+    b_by_time = {time: (brightness, rgb) for time, brightness, rgb in b}
+    differ = 0
+    first = None
+    worst = 0
+    for time, brightness, rgb in a:
+        if time not in b_by_time:
+            continue
+        other_brightness, other_rgb = b_by_time[time]
+        if brightness is None or other_brightness is None:
+            brightness = other_brightness = None  # a cache, only the colours count
+        if brightness != other_brightness or rgb != other_rgb:
+            differ += 1
+            first = time if first is None else first
+            worst = max(worst, max(abs(x - y) for x, y in zip(shown(rgb, brightness), shown(other_rgb, other_brightness))))
+    common = len(set(t for t, _, _ in a) & set(b_by_time))
+    if not differ:
+        print("{} frames the same".format(common))
+        return 0
+    print("{} of {} frames differ, first at {:.3f} s, largest difference {}".format(differ, common, first / 1000, worst))
+    return 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("frames", help=".frames file")
+    parser.add_argument("--png", help="write a png strip, one row per frame")
+    parser.add_argument("--scale", type=int, default=1, help="pixels per led and frame in the png")
+    parser.add_argument("--diff", metavar="OTHER", help="compare with another .frames file")
+    args = parser.parse_args()
+
+    if args.diff:
+        sys.exit(diff(args.frames, args.diff))
+    header, frames = read_frames(args.frames)
+    if args.png:
+        png_strip(header, frames, args.png, args.scale)
+        return
+    if "spans" in header:
+        print("{} leds, {} frames every {:.2f} ms in {} spans, {} bytes, {:.1f}% of raw".format(
+            header["leds"], header["frames"], header["period"] / 1000, header["spans"], header["bytes"],
+            100 * header["bytes"] / max(1, header["frames"] * 3 * header["leds"])))
+        return
+    lit = sum(1 for _, brightness, rgb in frames if brightness and any(rgb))
+    span = (frames[-1][0] - frames[0][0]) / 1000 if frames else 0
+    print("{} leds, {} frames every {:.2f} ms, {:.1f} s, {} frames lit".format(
+        header["leds"], header["frames"], header["period"] / 1000, span, lit))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+"""
+Compiles text shows into .show files for the sd card (src/ShowFileFormat.h), and back.
+
+A text show (song.cues) is one cue per line, the same cues as the tables in main.cpp:
+
+    # Stayin' alive
+    at   0.001       brightness 96
+    from 0.120       bpm 103
+    from 23.180      quarters Red Black Black Black
+    from 25.512      pulsing with fade 0.5
+    from 1:02.5      fill #FF8000
+
+    at|from  time  action  arguments...  [with fade|beat|wipe length]
+
+"with" makes a FROM cue blend in over the one before instead of cutting: fade and wipe take
+seconds (up to 2.55), beat takes a number of beats, see CueTransition in src/Cue.h.
+
+time is seconds, m:ss.sss or h:mm:ss.sss into the song, or bar.beat.tick in musical time
+(bars and beats from 1, 480 ticks to the beat) through the song's tempo map:
+
+    tempo 103 at 0.120           # bar 1 is at 0.120 s, 103 bpm, 4 beats to the bar
+    tempo 98 3/4 from 33         # 98 bpm and 3 beats to the bar from bar 33 on
+    from 9.1.0       quarters Red Black Black Black
+    from 9.2.0       quarters Red Green Black Black
+    at   9.2.240     fill White
+
+    tempo bpm [beats/4] at time|from bar
+
+The first tempo line says where bar 1 is, the others where the tempo or the beats per bar
+change. Musical times are turned into ms here, like the _BAR cues of src/TempoMap.h, so
+moving a show onto another edit of its song is one number in its first tempo line.
+
+The actions are the CueAction names
+from src/Cue.h without CUE_, in lower case (quarters, bpm, wiggle_lines, fill, fade,
+brightness...), read from that file so the two can't get out of step. Arguments named
+color in Cue.h take a FastLED colour name (Red, LawnGreen...) or #RRGGBB, all others a number.
+Lines starting with # are comments. Cues must be in time order, like the compiled in tables.
+
+    tools/showc.py song.cues              writes song.show
+    tools/showc.py song.cues -o x.show
+    tools/showc.py -d song.show           prints a .show file as text
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"SHOW"
+VERSION = 1
+HEADER = struct.Struct("<4sHHI")
+CUE = struct.Struct("<IBBBB4I")
+KINDS = {"at": 0, "from": 1}
+TICKS_PER_BEAT = 480  # like src/TempoMap.h
+BAR_TIME = re.compile(r"^(\d+)\.(\d+)\.(\d+)$")
+
+# FastLED's CRGB::HTMLColorCode names, the html colour values
+COLORS = {
+    "AliceBlue": 0xF0F8FF, "AntiqueWhite": 0xFAEBD7, "Aqua": 0x00FFFF, "Aquamarine": 0x7FFFD4,
+    "Azure": 0xF0FFFF, "Beige": 0xF5F5DC, "Bisque": 0xFFE4C4, "Black": 0x000000, "BlanchedAlmond": 0xFFEBCD,
+    "Blue": 0x0000FF, "BlueViolet": 0x8A2BE2, "Brown": 0xA52A2A, "BurlyWood": 0xDEB887,
+    "CadetBlue": 0x5F9EA0, "Chartreuse": 0x7FFF00, "Chocolate": 0xD2691E, "Coral": 0xFF7F50,
+    "CornflowerBlue": 0x6495ED, "Cornsilk": 0xFFF8DC, "Crimson": 0xDC143C, "Cyan": 0x00FFFF,
+    "DarkBlue": 0x00008B, "DarkCyan": 0x008B8B, "DarkGoldenrod": 0xB8860B, "DarkGray": 0xA9A9A9,
+    "DarkGrey": 0xA9A9A9, "DarkGreen": 0x006400, "DarkKhaki": 0xBDB76B, "DarkMagenta": 0x8B008B,
+    "DarkOliveGreen": 0x556B2F, "DarkOrange": 0xFF8C00, "DarkOrchid": 0x9932CC, "DarkRed": 0x8B0000,
+    "DarkSalmon": 0xE9967A, "DarkSeaGreen": 0x8FBC8F, "DarkSlateBlue": 0x483D8B, "DarkSlateGray": 0x2F4F4F,
+    "DarkSlateGrey": 0x2F4F4F, "DarkTurquoise": 0x00CED1, "DarkViolet": 0x9400D3, "DeepPink": 0xFF1493,
+    "DeepSkyBlue": 0x00BFFF, "DimGray": 0x696969, "DimGrey": 0x696969, "DodgerBlue": 0x1E90FF,
+    "FireBrick": 0xB22222, "FloralWhite": 0xFFFAF0, "ForestGreen": 0x228B22, "Fuchsia": 0xFF00FF,
+    "Gainsboro": 0xDCDCDC, "GhostWhite": 0xF8F8FF, "Gold": 0xFFD700, "Goldenrod": 0xDAA520, "Gray": 0x808080,
+    "Grey": 0x808080, "Green": 0x008000, "GreenYellow": 0xADFF2F, "Honeydew": 0xF0FFF0, "HotPink": 0xFF69B4,
+    "IndianRed": 0xCD5C5C, "Indigo": 0x4B0082, "Ivory": 0xFFFFF0, "Khaki": 0xF0E68C, "Lavender": 0xE6E6FA,
+    "LavenderBlush": 0xFFF0F5, "LawnGreen": 0x7CFC00, "LemonChiffon": 0xFFFACD, "LightBlue": 0xADD8E6,
+    "LightCoral": 0xF08080, "LightCyan": 0xE0FFFF, "LightGoldenrodYellow": 0xFAFAD2, "LightGreen": 0x90EE90,
+    "LightGrey": 0xD3D3D3, "LightPink": 0xFFB6C1, "LightSalmon": 0xFFA07A, "LightSeaGreen": 0x20B2AA,
+    "LightSkyBlue": 0x87CEFA, "LightSlateGray": 0x778899, "LightSlateGrey": 0x778899,
+    "LightSteelBlue": 0xB0C4DE, "LightYellow": 0xFFFFE0, "Lime": 0x00FF00, "LimeGreen": 0x32CD32,
+    "Linen": 0xFAF0E6, "Magenta": 0xFF00FF, "Maroon": 0x800000, "MediumAquamarine": 0x66CDAA,
+    "MediumBlue": 0x0000CD, "MediumOrchid": 0xBA55D3, "MediumPurple": 0x9370DB, "MediumSeaGreen": 0x3CB371,
+    "MediumSlateBlue": 0x7B68EE, "MediumSpringGreen": 0x00FA9A, "MediumTurquoise": 0x48D1CC,
+    "MediumVioletRed": 0xC71585, "MidnightBlue": 0x191970, "MintCream": 0xF5FFFA, "MistyRose": 0xFFE4E1,
+    "Moccasin": 0xFFE4B5, "NavajoWhite": 0xFFDEAD, "Navy": 0x000080, "OldLace": 0xFDF5E6, "Olive": 0x808000,
+    "OliveDrab": 0x6B8E23, "Orange": 0xFFA500, "OrangeRed": 0xFF4500, "Orchid": 0xDA70D6,
+    "PaleGoldenrod": 0xEEE8AA, "PaleGreen": 0x98FB98, "PaleTurquoise": 0xAFEEEE, "PaleVioletRed": 0xDB7093,
+    "PapayaWhip": 0xFFEFD5, "PeachPuff": 0xFFDAB9, "Peru": 0xCD853F, "Pink": 0xFFC0CB, "Plum": 0xDDA0DD,
+    "PowderBlue": 0xB0E0E6, "Purple": 0x800080, "Red": 0xFF0000, "RosyBrown": 0xBC8F8F,
+    "RoyalBlue": 0x4169E1, "SaddleBrown": 0x8B4513, "Salmon": 0xFA8072, "SandyBrown": 0xF4A460,
+    "SeaGreen": 0x2E8B57, "Seashell": 0xFFF5EE, "Sienna": 0xA0522D, "Silver": 0xC0C0C0, "SkyBlue": 0x87CEEB,
+    "SlateBlue": 0x6A5ACD, "SlateGray": 0x708090, "SlateGrey": 0x708090, "Snow": 0xFFFAFA,
+    "SpringGreen": 0x00FF7F, "SteelBlue": 0x4682B4, "Tan": 0xD2B48C, "Teal": 0x008080, "Thistle": 0xD8BFD8,
+    "Tomato": 0xFF6347, "Turquoise": 0x40E0D0, "Violet": 0xEE82EE, "Wheat": 0xF5DEB3, "White": 0xFFFFFF,
+    "WhiteSmoke": 0xF5F5F5, "Yellow": 0xFFFF00, "YellowGreen": 0x9ACD32, "FairyLight": 0xFFE42D,
+    "FairyLightNCC": 0xFF9D2A,
+}
+COLOR_NAMES = {value: name for name, value in reversed(list(COLORS.items()))}
+COLORS_LOWER = {name.lower(): value for name, value in COLORS.items()}
+
+
+def read_actions(cue_h):
+    """CueAction names -> (number, argument names) from the enum and its comments in Cue.h"""
+    text = open(cue_h).read()
+    body = re.search(r"enum CueAction[^{]*{(.*?)};", text, re.S).group(1)
+    actions = {}
+    for number, (name, comment) in enumerate(re.findall(r"^\s*CUE_(\w+),[ \t]*(?://(.*))?$", body, re.M)):
+        # "quarters(color1, color2, color3, color4)" or "gHue = hue"
+        args = re.search(r"\((.*)\)", comment or "") or re.search(r"=\s*(\w+)", comment or "")
+        names = [a.strip() for a in args.group(1).split(",") if a.strip()] if args else []
+        actions[name.lower()] = (number, names)
+    return actions
+
+
+def read_transitions(cue_h):
+    """CueTransition names -> numbers"""
+    body = re.search(r"enum CueTransition[^{]*{(.*?)};", open(cue_h).read(), re.S).group(1)
+    return {name.lower(): number for number, name in enumerate(re.findall(r"^\s*TRANSITION_(\w+),", body, re.M))}
+
+
+def parse_transition(words, transitions):
+    """["fade", "0.5"] -> (transition, length)"""
+    if len(words) != 2 or words[0].lower() not in transitions or words[0].lower() == "cut":
+        raise ValueError("expected: with {} length".format("|".join(t for t in transitions if t != "cut")))
+    if words[0].lower() == "beat":
+        length = int(words[1])
+    else:
+        length = int(round(float(words[1]) * 100))
+    if not 1 <= length <= 255:
+        raise ValueError("transition length out of range")
+    return transitions[words[0].lower()], length
+
+
+def format_transition(transition, length, transitions):
+    names = {number: name for name, number in transitions.items()}
+    name = names.get(transition, str(transition))
+    return " with {} {}".format(name, length if name == "beat" else "{:g}".format(length / 100))
+
+
+def parse_time(text):
+    seconds = 0.0
+    for part in text.split(":"):
+        seconds = seconds * 60 + float(part)
+    return int(round(seconds * 1000))
+
+
+def parse_tempo(words, sections):
+    """["103", "4/4", "at", "0.120"] or ["98", "from", "33"] -> appended to sections as
+    [first bar, beats per bar, bpm, ms of bar 1 or None]"""
+    bpm = struct.unpack("<f", struct.pack("<f", float(words[0])))[0]  # a float like TempoSection.bpm
+    beats = sections[-1][1] if sections else 4
+    if len(words) > 1 and "/" in words[1]:
+        beats = int(words[1].split("/")[0])
+        words = words[:1] + words[2:]
+    if bpm <= 0 or beats < 1:
+        raise ValueError("tempo and beats per bar must be more than 0")
+    if len(words) == 3 and words[1].lower() == "at" and not sections:
+        sections.append([1, beats, bpm, parse_time(words[2])])
+    elif len(words) == 3 and words[1].lower() == "from" and sections:
+        bar = int(words[2])
+        if bar <= sections[-1][0]:
+            raise ValueError("tempo changes must be in bar order")
+        sections.append([bar, beats, bpm, None])
+    else:
+        raise ValueError("expected: tempo bpm [beats/4] at time, then tempo bpm [beats/4] from bar")
+
+
+def bar_millis(sections, bar, beat, tick):
+    """bar.beat.tick -> ms, the same sums as barMillis() in src/TempoMap.h"""
+    if not sections:
+        raise ValueError("bar.beat.tick time before a tempo line")
+    start = sections[0][3]
+    section = sections[0]
+    for previous, following in zip(sections, sections[1:]):
+        if following[0] > bar:
+            break
+        start += (following[0] - previous[0]) * previous[1] * 60000.0 / previous[2]
+        section = following
+    first, beats, bpm, _ = section
+    return int(start + ((bar - first) * beats + (beat - 1) + tick / TICKS_PER_BEAT) * 60000.0 / bpm + 0.5)
+
+
+def format_time(ms):
+    minutes, ms = divmod(ms, 60000)
+    return "{}:{:06.3f}".format(minutes, ms / 1000)
+
+
+def parse_arg(text, name):
+    if "color" in name:
+        if text.startswith("#"):
+            return int(text[1:], 16)
+        if text.lower() in COLORS_LOWER:
+            return COLORS_LOWER[text.lower()]
+        raise ValueError("unknown colour " + text)
+    return int(text, 0)
+
+
+def compile_show(path, actions, transitions):
+    cues = []
+    sections = []
+    for number, line in enumerate(open(path), 1):
+        words = line.split()
+        if not words or words[0].startswith("#"):
+            continue
+        try:
+            if words[0].lower() == "tempo":
+                parse_tempo(words[1:], sections)
+                continue
+            if len(words) < 3:
+                raise ValueError("expected: at|from time action arguments")
+            bar_time = BAR_TIME.match(words[1])
+            # musical times wait for the whole tempo map, a tempo change can come after them
+            time = tuple(int(part) for part in bar_time.groups()) if bar_time else parse_time(words[1])
+            kind, action, args = words[0].lower(), words[2].lower(), words[3:]
+            if kind not in KINDS:
+                raise ValueError("cue must start with at or from")
+            transition, length = 0, 0
+            if "with" in [a.lower() for a in args]:
+                split = [a.lower() for a in args].index("with")
+                if kind != "from":
+                    raise ValueError("only from cues have transitions")
+                transition, length = parse_transition(args[split + 1:], transitions)
+                args = args[:split]
+            if action not in actions:
+                raise ValueError("unknown action " + action)
+            action_number, arg_names = actions[action]
+            if len(args) != len(arg_names):
+                raise ValueError("{} takes {} arguments ({})".format(action, len(arg_names), ", ".join(arg_names)))
+            values = [parse_arg(a, n) for a, n in zip(args, arg_names)] + [0] * (4 - len(args))
+        except ValueError as e:
+            sys.exit("{}:{}: {}".format(path, number, e))
+        cues.append((number, [time, KINDS[kind], action_number, transition, length, *values]))
+
+    for i, (number, cue) in enumerate(cues):
+        try:
+            if isinstance(cue[0], tuple):
+                bar, beat, tick = cue[0]
+                if bar < 1 or beat < 1:
+                    raise ValueError("bars and beats count from 1")
+                cue[0] = bar_millis(sections, bar, beat, tick)
+            if i and cue[0] < cues[i - 1][1][0]:
+                raise ValueError("cue is before the one above it, cues must be in time order")
+        except ValueError as e:
+            sys.exit("{}:{}: {}".format(path, number, e))
+    return HEADER.pack(MAGIC, VERSION, 0, len(cues)) + b"".join(CUE.pack(*cue) for _, cue in cues)
+
+
+def decompile_show(path, actions, transitions):
+    data = open(path, "rb").read()
+    magic, version, _, count = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        sys.exit("{}: not a version {} show file".format(path, VERSION))
+    by_number = {number: (name, args) for name, (number, args) in actions.items()}
+    for i in range(count):
+        time, kind, action, transition, length, *values = CUE.unpack_from(data, HEADER.size + i * CUE.size)
+        name, arg_names = by_number.get(action, ("action{}".format(action), []))
+        args = [COLOR_NAMES.get(v, "#{:06X}".format(v)) if "color" in n else str(v) for v, n in zip(values, arg_names)]
+        blend = format_transition(transition, length, transitions) if transition else ""
+        print("{:<4} {:<10} {}{}".format("at" if kind == 0 else "from", format_time(time), " ".join([name] + args), blend))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("source", help="text show, or .show file with -d")
+    parser.add_argument("-o", "--output", help="default: source with .show extension")
+    parser.add_argument("-d", "--decompile", action="store_true", help="print a .show file as text")
+    parser.add_argument("--cue-h", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "Cue.h"))
+    args = parser.parse_args()
+
+    actions = read_actions(args.cue_h)
+    transitions = read_transitions(args.cue_h)
+    if args.decompile:
+        decompile_show(args.source, actions, transitions)
+        return
+    show = compile_show(args.source, actions, transitions)
+    output = args.output or os.path.splitext(args.source)[0] + ".show"
+    with open(output, "wb") as f:
+        f.write(show)
+    print("{}: {} cues, {} bytes".format(output, (len(show) - HEADER.size) // CUE.size, len(show)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""
+Decoder and plotter for the beat detection telemetry (src/TelemetryFormat.h).
+
+Reads packets from a serial port (the teensy with beatDetector.enableSerialBeatDisplay
+set) or from a file written by the host replay (program -t FILE song.wav), checks them
+and either prints the records as csv or plots average/max/threshold/value per band.
+Text the firmware prints on the same port is skipped while looking for the next packet.
+
+    tools/telemetry.py /dev/ttyACM0 --plot      live, needs pyserial and matplotlib
+    tools/telemetry.py song.tlm --csv > song.csv
+    tools/telemetry.py song.tlm --plot --band 0
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+VERSION = 1
+HEADER = struct.Struct("<2sBBHH")
+RECORD = struct.Struct("<IBBHffff")
+ONSET = 0xFF
+READY = 0x01
+BEAT = 0x02
+
+
+def fletcher16(data):
+    sum1 = sum2 = 0
+    for byte in data:
+        sum1 = (sum1 + byte) % 255
+        sum2 = (sum2 + sum1) % 255
+    return (sum2 << 8) | sum1
+
+
+def band_name(band):
+    return "onset" if band == ONSET else "band%d" % band
+
+
+class Decoder:
+    """feed() it bytes as they come, it returns the records of every complete, valid packet"""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.bad_packets = 0
+        self.dropped = 0
+
+    def feed(self, data):
+        self.buffer += data
+        records = []
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:-1]  # keep a possible first sync byte
+                return records
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER.size:
+                return records
+            _, version, count, dropped, _ = HEADER.unpack_from(self.buffer)
+            size = HEADER.size + count * RECORD.size + 2
+            if version != VERSION or count == 0:
+                del self.buffer[:1]
+                continue
+            if len(self.buffer) < size:
+                return records
+            (checksum,) = struct.unpack_from("<H", self.buffer, size - 2)
+            if checksum != fletcher16(self.buffer[: size - 2]):
+                # not a packet after all, or damaged: look for the next sync
+                self.bad_packets += 1
+                del self.buffer[:1]
+                continue
+            self.dropped += dropped
+            for i in range(count):
+                records.append(RECORD.unpack_from(self.buffer, HEADER.size + i * RECORD.size))
+            del self.buffer[:size]
+
+
+def open_source(path):
+    if path.startswith("/dev/") or path.upper().startswith("COM"):
+        import serial  # pyserial, only needed for live data
+
+        port = serial.Serial(path, 115200, timeout=0.1)
+        return lambda: port.read(4096), True
+    f = open(path, "rb")
+    return lambda: f.read(65536), False
+
+
+def print_csv(read, live, decoder):
+    print("micros,band,frame,average,max,threshold,value,ready,beat")
+    while True:
+        data = read()
+        if not data:
+            if live:
+                continue  # serial read timed out, keep waiting for the teensy
+            break
+        for micros, band, flags, frame, average, maximum, threshold, value in decoder.feed(data):
+            print("%d,%s,%d,%g,%g,%g,%g,%d,%d" % (micros, band_name(band), frame, average, maximum, threshold, value,
+                                                 flags & READY != 0, flags & BEAT != 0), flush=live)
+
+
+def plot(read, live, decoder, only_band, seconds):
+    import matplotlib.pyplot as plt
+
+    series = {}  # band -> lists of time, average, max, threshold, value, beat times
+
+    def add(records):
+        for micros, band, flags, _, average, maximum, threshold, value in records:
+            if only_band is not None and band != only_band:
+                continue
+            s = series.setdefault(band, ([], [], [], [], [], []))
+            for column, v in zip(s, (micros / 1e6, average, maximum, threshold, value)):
+                column.append(v)
+            if flags & BEAT:
+                s[5].append(micros / 1e6)
+
+    def draw(axes):
+        for ax, band in zip(axes, sorted(series)):
+            t, average, maximum, threshold, value, beats = series[band]
+            if live:
+                # only the last few seconds
+                while t and t[0] < t[-1] - seconds:
+                    for column in series[band][:5]:
+                        del column[0]
+                while beats and beats[0] < t[0]:
+                    del beats[0]
+            ax.clear()
+            ax.plot(t, value, label="value", linewidth=0.8)
+            ax.plot(t, average, label="average")
+            ax.plot(t, maximum, label="max")
+            ax.plot(t, threshold, label="threshold")
+            for b in beats:
+                ax.axvline(b, color="red", alpha=0.3, linewidth=0.8)
+            ax.set_ylabel(band_name(band))
+        axes[0].legend(loc="upper right", fontsize="small")
+        axes[-1].set_xlabel("s")
+
+    if not live:
+        while True:
+            data = read()
+            if not data:
+                break
+            add(decoder.feed(data))
+        if not series:
+            sys.exit("no telemetry found")
+        fig, axes = plt.subplots(len(series), 1, sharex=True, squeeze=False)
+        draw(axes[:, 0])
+        plt.show()
+        return
+
+    plt.ion()
+    fig = None
+    while plt.fignum_exists(fig.number) if fig else True:
+        add(decoder.feed(read()))
+        if series and (fig is None or len(fig.axes) != len(series)):
+            plt.close("all")
+            fig, axes = plt.subplots(len(series), 1, sharex=True, squeeze=False)
+        if fig:
+            draw(axes[:, 0])
+            plt.pause(0.05)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("source", help="serial port or telemetry file")
+    parser.add_argument("--csv", action="store_true", help="print the records as csv instead of plotting")
+    parser.add_argument("--plot", action="store_true", help="plot (the default)")
+    parser.add_argument("--band", type=lambda v: ONSET if v == "onset" else int(v), help="only this band (number or 'onset')")
+    parser.add_argument("--seconds", type=float, default=5, help="live plot window")
+    args = parser.parse_args()
+
+    read, live = open_source(args.source)
+    decoder = Decoder()
+    try:
+        if args.csv:
+            print_csv(read, live, decoder)
+        else:
+            plot(read, live, decoder, args.band, args.seconds)
+    except KeyboardInterrupt:
+        pass
+    if decoder.bad_packets or decoder.dropped:
+        print("%d bad packets, %d records dropped on the teensy" % (decoder.bad_packets, decoder.dropped), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()